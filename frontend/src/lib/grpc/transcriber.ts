@@ -27,6 +27,8 @@ export async function transcribe(
         const call: ClientDuplexStream<Chunk, Transcript> = client.transcribe();
 
         const onData = (response: Transcript) => {
+            // The worker reports the position of queued requests before it transcribes them
+            if (response.queuePosition > 0) return;
             callback(response.id, response.text);
         };
 
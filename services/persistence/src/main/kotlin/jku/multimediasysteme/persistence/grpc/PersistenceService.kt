@@ -12,7 +12,6 @@ import jku.multimediasysteme.shared.jpa.transcription.repository.SummaryReposito
 import jku.multimediasysteme.shared.jpa.transcription.repository.TranscriptionRepository
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.flow.Flow
-import kotlinx.coroutines.flow.toList
 import kotlinx.coroutines.withContext
 import net.devh.boot.grpc.server.service.GrpcService
 import java.util.*
@@ -29,22 +28,84 @@ class PersistenceService(
 ) : PersistenceGrpcKt.PersistenceCoroutineImplBase() {
 
     /**
-     * Persists a transcription from a stream of text chunks.
-     * Builds the final transcription text and saves it to the database.
+     * Persists transcriptions from a stream of text chunks.
+     * A stream may carry many transcriptions, their chunks are grouped by transcript ID and every
+     * transcription is saved once its finished chunk arrives. Transcriptions that are not marked as
+     * finished are saved when the stream ends.
      *
-     * @param requests a flow of Chunk objects representing the streamed transcription
+     * @param requests a flow of Chunk objects representing the streamed transcriptions
      * @return an empty response if successful
      * @throws io.grpc.StatusException if the input is empty
      */
     override suspend fun persistTranscript(requests: Flow<Chunk>): Empty {
-        val chunks = requests.toList()  // Collect all streamed chunks
-        if (chunks.isEmpty()) {
+        val received = collectGrouped(requests, { it.transcriptId }) { saveTranscription(it) }
+        if (!received) {
             // Return error if stream is empty
             throw Status.FAILED_PRECONDITION
                 .withDescription("No chunks received")
                 .asException()
         }
 
+        return Empty.getDefaultInstance() // Return empty gRPC response
+    }
+
+    /**
+     * Persists summaries from a stream of text chunks.
+     * A stream may carry many summaries, their chunks are grouped by summary ID and every
+     * summary is saved once its finished chunk arrives. Summaries that are not marked as
+     * finished are saved when the stream ends.
+     *
+     * @param requests a flow of Chunk objects representing the streamed summaries
+     * @return an empty response if successful
+     * @throws io.grpc.StatusException if the input is empty
+     */
+    override suspend fun persistSummary(requests: Flow<Chunk>): Empty {
+        val received = collectGrouped(requests, { it.summaryId }) { saveSummary(it) }
+        if (!received) {
+            // Return error if stream is empty
+            throw Status.FAILED_PRECONDITION
+                .withDescription("No chunks received")
+                .asException()
+        }
+
+        return Empty.getDefaultInstance() // Return empty gRPC response
+    }
+
+    /**
+     * Collects the chunks of a stream grouped by their ID and passes every complete group to the save function.
+     *
+     * @param requests the streamed chunks
+     * @param key extracts the ID that the chunks are grouped by
+     * @param save persists the chunks of one group
+     * @return whether any chunk was received
+     */
+    private suspend fun collectGrouped(
+        requests: Flow<Chunk>,
+        key: (Chunk) -> String,
+        save: suspend (List<Chunk>) -> Unit
+    ): Boolean {
+        val pending = LinkedHashMap<String, MutableList<Chunk>>()
+        var received = false
+        requests.collect { chunk ->
+            received = true
+            if (chunk.finished) {
+                pending.remove(key(chunk))?.let { save(it) }
+            } else {
+                pending.getOrPut(key(chunk)) { mutableListOf() }.add(chunk)
+            }
+        }
+
+        // Clients that open one stream per transcription or summary do not mark the end
+        pending.values.forEach { save(it) }
+        return received
+    }
+
+    /**
+     * Builds the final transcription text from its chunks and saves it to the database.
+     *
+     * @param chunks the chunks of one transcription, in order
+     */
+    private suspend fun saveTranscription(chunks: List<Chunk>) {
         val first = chunks.first()  // First chunk (used to calculate duration)
         val last = chunks.last()    // Last chunk (used to calculate duration + IDs)
 
@@ -65,26 +126,14 @@ class PersistenceService(
             transcriptionRepository.save(transcription)
             upsertSmartSession(transcriptId = id, transcription = transcription)
         }
-
-        return Empty.getDefaultInstance() // Return empty gRPC response
     }
 
     /**
-     * Persists a summary from a stream of text chunks.
-     * Builds the final summary text and saves it to the database.
+     * Builds the final summary text from its chunks and saves it to the database.
      *
-     * @param requests a flow of Chunk objects representing the streamed summary
-     * @return an empty response if successful
-     * @throws io.grpc.StatusException if the input is empty
+     * @param chunks the chunks of one summary, in order
      */
-    override suspend fun persistSummary(requests: Flow<Chunk>): Empty {
-        val chunks = requests.toList() // Collect all streamed chunks
-        if (chunks.isEmpty()) {
-            // Return error if stream is empty
-            throw Status.FAILED_PRECONDITION
-                .withDescription("No chunks received")
-                .asException()
-        }
+    private suspend fun saveSummary(chunks: List<Chunk>) {
         val first = chunks.first()  // First chunk (used to calculate duration)
         val last = chunks.last()    // Last chunk (used to calculate duration + IDs)
 
@@ -95,14 +144,11 @@ class PersistenceService(
         val userId = UUID.fromString(last.userId)                                     // Extract user ID
         val summary = Summary(id, userId, text, System.currentTimeMillis(), duration) // Build entity
 
-
         // Persist data in the database
         withContext(Dispatchers.IO) {
             summaryRepository.save(summary)
             upsertSmartSession(transcriptId = transcriptId, summary = summary)
         }
-
-        return Empty.getDefaultInstance() // Return empty gRPC response
     }
 
     /**
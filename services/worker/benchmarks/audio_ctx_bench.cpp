@@ -0,0 +1,77 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "benchmark_whisper.h"
+#include "whisper_params.h"
+
+namespace {
+
+constexpr usize SAMPLE_RATE = 16000;
+
+}// anonymous namespace
+
+/**
+ * Transcribes a trailing window of the given length, with the full encoder context of 30 seconds or with
+ * the context that the worker fits to the window. The first argument is the length of the window in seconds,
+ * the second whether the audio context is fitted.
+ */
+static void BM_TrailingWindow(benchmark::State &state) {
+    auto *context = benchmark_model();
+    if (not context) {
+        state.SkipWithError("Cannot load the whisper model, see WORKER_BENCHMARK_MODEL");
+        return;
+    }
+
+    auto const &pcm = benchmark_pcm();
+    auto const samples = static_cast<usize>(state.range(0)) * SAMPLE_RATE;
+    if (pcm.size() < samples) {
+        state.SkipWithError("The benchmark media is too short");
+        return;
+    }
+
+    auto params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    params.audio_ctx = state.range(1) != 0 ? fit_audio_ctx(context, samples) : 0;
+    params.print_progress = false;
+    params.print_realtime = false;
+
+    auto *whisper_state = whisper_init_state(context);
+    for (auto _: state) {
+        if (whisper_full_with_state(context, whisper_state, params, pcm.data(), static_cast<int>(samples)) != 0) {
+            state.SkipWithError("Failed to process audio");
+            break;
+        }
+    }
+    whisper_free_state(whisper_state);
+    state.counters["audio_ctx"] = params.audio_ctx;
+}
+BENCHMARK(BM_TrailingWindow)
+        ->ArgNames({ "seconds", "fitted" })
+        ->ArgsProduct({ { 2, 5, 10, 20 }, { 0, 1 } })
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
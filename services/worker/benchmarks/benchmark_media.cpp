@@ -0,0 +1,125 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "benchmark_media.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// The format of the generated media
+constexpr u32 GENERATED_RATE = 48000;
+constexpr u16 GENERATED_CHANNELS = 2;
+constexpr u32 GENERATED_SECONDS = 600;
+
+// The size of the chunks the media is split into, about what the frontend sends
+constexpr usize CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Appends a little endian integer
+ * @param out The destination
+ * @param value The value
+ * @param size The size of the integer in bytes
+ */
+void put(std::string &out, u32 const value, usize const size) {
+    for (usize i = 0; i < size; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/**
+ * Generates a WAV file of tones that change every 150 ms over some noise, which is roughly what speech
+ * looks like to the decoder and the resampler
+ * @return The file contents
+ */
+std::string generate_wav() {
+    auto const frames = GENERATED_RATE * GENERATED_SECONDS;
+    auto const data_size = frames * GENERATED_CHANNELS * static_cast<u32>(sizeof(s16));
+
+    std::string wav;
+    wav.reserve(44 + data_size);
+    wav += "RIFF";
+    put(wav, 36 + data_size, 4);
+    wav += "WAVEfmt ";
+    put(wav, 16, 4);
+    put(wav, 1, 2);
+    put(wav, GENERATED_CHANNELS, 2);
+    put(wav, GENERATED_RATE, 4);
+    put(wav, GENERATED_RATE * GENERATED_CHANNELS * sizeof(s16), 4);
+    put(wav, GENERATED_CHANNELS * sizeof(s16), 2);
+    put(wav, 16, 2);
+    wav += "data";
+    put(wav, data_size, 4);
+
+    std::mt19937 random{ 42 };
+    std::uniform_real_distribution<f64> pitch{ 100.0, 1000.0 };
+    std::normal_distribution<f64> noise{ 0.0, 300.0 };
+    f64 frequency = 0.0;
+    for (u32 i = 0; i < frames; ++i) {
+        if (i % (GENERATED_RATE * 15 / 100) == 0) {
+            frequency = pitch(random);
+        }
+
+        auto const tone = 6000.0 * std::sin(2.0 * std::numbers::pi * frequency * i / GENERATED_RATE);
+        for (u16 channel = 0; channel < GENERATED_CHANNELS; ++channel) {
+            put(wav, static_cast<u16>(static_cast<s16>(tone + noise(random))), 2);
+        }
+    }
+
+    return wav;
+}
+
+/**
+ * Loads the media file that WORKER_BENCHMARK_MEDIA points to
+ * @param path The path of the media file
+ * @return The file contents
+ */
+std::string load_file(char const *path) {
+    std::ifstream file{ path, std::ios::binary };
+    if (not file) {
+        throw std::runtime_error{ std::string{ "Cannot open benchmark media " } + path };
+    }
+    return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+}
+
+}// anonymous namespace
+
+MediaBuffer const &benchmark_media() {
+    static MediaBuffer const media = [] {
+        auto const *path = std::getenv("WORKER_BENCHMARK_MEDIA");
+        auto const contents = path ? load_file(path) : generate_wav();
+
+        // The media is held in chunks, just like an upload
+        MediaBuffer buffer;
+        for (usize offset = 0; offset < contents.size(); offset += CHUNK_SIZE) {
+            buffer.append(contents.substr(offset, CHUNK_SIZE));
+        }
+        return buffer;
+    }();
+    return media;
+}
@@ -0,0 +1,37 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef BENCHMARK_MEDIA_H
+#define BENCHMARK_MEDIA_H
+
+#include "media_buffer.h"
+
+/**
+ * The media that the benchmarks decode. WORKER_BENCHMARK_MEDIA points to a media file, e.g. the recording
+ * of a meeting with a video stream. Without it, ten minutes of generated 48 kHz stereo audio in a WAV file
+ * are used, which has no other streams to skip.
+ * @return The media, which is loaded on the first call
+ */
+[[nodiscard]] MediaBuffer const &benchmark_media();
+
+#endif// BENCHMARK_MEDIA_H
@@ -0,0 +1,67 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "benchmark_whisper.h"
+
+#include <cstdlib>
+
+#include "benchmark_media.h"
+#include "decode.h"
+
+namespace {
+
+// The model that is used unless WORKER_BENCHMARK_MODEL is set
+constexpr auto DEFAULT_MODEL = "models/ggml-tiny.bin";
+
+// The media is decoded in windows of this size
+constexpr usize DECODE_WINDOW = 16000 * 30;
+
+}// anonymous namespace
+
+whisper_context *benchmark_model() {
+    static whisper_context *const context = [] {
+        auto const *path = std::getenv("WORKER_BENCHMARK_MODEL");
+        return whisper_init_from_file_with_params(path ? path : DEFAULT_MODEL, whisper_context_default_params());
+    }();
+    return context;
+}
+
+std::vector<f32> const &benchmark_pcm() {
+    static std::vector<f32> const pcm = [] {
+        std::vector<f32> samples;
+        MediaBuffer::Reader reader{ benchmark_media() };
+        auto stream = PcmStream::open(reader);
+        if (not stream) {
+            return samples;
+        }
+
+        std::vector<f32> converted;
+        for (auto window = stream->next_window(DECODE_WINDOW); not window.empty();
+             window = stream->next_window(DECODE_WINDOW)) {
+            pcm_to_f32(window, converted);
+            samples.insert(samples.end(), converted.begin(), converted.end());
+        }
+        return samples;
+    }();
+    return pcm;
+}
@@ -0,0 +1,46 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef BENCHMARK_WHISPER_H
+#define BENCHMARK_WHISPER_H
+
+#include <vector>
+
+#include <whisper.h>
+
+#include "types.h"
+
+/**
+ * The whisper model that the benchmarks transcribe with. WORKER_BENCHMARK_MODEL points to the model file,
+ * models/ggml-tiny.bin relative to the working directory is used otherwise.
+ * @return The model, which is loaded on the first call, or nullptr if it cannot be loaded
+ */
+[[nodiscard]] whisper_context *benchmark_model();
+
+/**
+ * The benchmark media, decoded to 16 kHz mono float samples as whisper expects them
+ * @return The samples, which are decoded on the first call, or nothing if the media cannot be decoded
+ */
+[[nodiscard]] std::vector<f32> const &benchmark_pcm();
+
+#endif// BENCHMARK_WHISPER_H
@@ -0,0 +1,54 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_media.h"
+#include "decode.h"
+
+namespace {
+
+// One second of PCM at 16 kHz, the probing is done once the first second is decoded
+constexpr usize FIRST_WINDOW = 16000;
+
+}// anonymous namespace
+
+/**
+ * Measures the time from opening the media to its first second of PCM, with and without the audio-only
+ * probing. The difference is large for media with video streams, see WORKER_BENCHMARK_MEDIA.
+ */
+static void BM_ProbeLatency(benchmark::State &state) {
+    auto const &media = benchmark_media();
+    DecodeOptions const options{ .audio_only = state.range(0) != 0 };
+
+    for (auto _: state) {
+        MediaBuffer::Reader reader{ media };
+        auto stream = PcmStream::open(reader, options);
+        if (not stream) {
+            state.SkipWithError(stream.error().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(stream->next_window(FIRST_WINDOW).data());
+    }
+}
+BENCHMARK(BM_ProbeLatency)->ArgName("audio_only")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
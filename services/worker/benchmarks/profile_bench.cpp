@@ -0,0 +1,170 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_whisper.h"
+#include "whisper_params.h"
+
+namespace {
+
+// The media is transcribed in windows of 30 seconds at 16 kHz, like the worker without a voice detector
+constexpr usize SAMPLE_RATE = 16000;
+constexpr usize WINDOW_SIZE = SAMPLE_RATE * 30;
+
+/**
+ * Splits a text into lower case words without punctuation
+ * @param text The text
+ * @return The words
+ */
+std::vector<std::string> words(std::string const &text) {
+    std::vector<std::string> result;
+    std::istringstream stream{ text };
+    for (std::string word; stream >> word;) {
+        std::erase_if(word, [](unsigned char const c) { return std::ispunct(c) != 0; });
+        std::ranges::transform(word, word.begin(), [](unsigned char const c) { return std::tolower(c); });
+        if (not word.empty()) {
+            result.push_back(std::move(word));
+        }
+    }
+    return result;
+}
+
+/**
+ * Computes the word error rate, i.e. the word-level edit distance relative to the length of the reference
+ * @param reference The reference transcript
+ * @param hypothesis The transcript to rate
+ * @return The word error rate
+ */
+f64 word_error_rate(std::string const &reference, std::string const &hypothesis) {
+    auto const expected = words(reference);
+    auto const actual = words(hypothesis);
+    if (expected.empty()) {
+        return actual.empty() ? 0.0 : 1.0;
+    }
+
+    // The edit distance row by row, previous holds the distances of the previous reference word
+    std::vector<usize> previous(actual.size() + 1);
+    std::vector<usize> current(actual.size() + 1);
+    for (usize j = 0; j <= actual.size(); ++j) {
+        previous[j] = j;
+    }
+    for (usize i = 1; i <= expected.size(); ++i) {
+        current[0] = i;
+        for (usize j = 1; j <= actual.size(); ++j) {
+            auto const substitution = previous[j - 1] + (expected[i - 1] == actual[j - 1] ? 0 : 1);
+            current[j] = std::min({ substitution, previous[j] + 1, current[j - 1] + 1 });
+        }
+        std::swap(previous, current);
+    }
+    return static_cast<f64>(previous[actual.size()]) / static_cast<f64>(expected.size());
+}
+
+/**
+ * The reference transcript of the benchmark media, which WORKER_BENCHMARK_REFERENCE points to
+ * @return The transcript, or nothing if there is no reference
+ */
+std::string const &reference_transcript() {
+    static std::string const reference = [] {
+        auto const *path = std::getenv("WORKER_BENCHMARK_REFERENCE");
+        if (not path) {
+            return std::string{};
+        }
+        std::ifstream file{ path };
+        return std::string{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }();
+    return reference;
+}
+
+}// anonymous namespace
+
+/**
+ * Transcribes the benchmark media with the parameters of a profile, the argument is the profile. Reports the
+ * realtime factor and, if WORKER_BENCHMARK_REFERENCE points to the transcript of the media, the word error rate.
+ */
+static void BM_Profile(benchmark::State &state) {
+    auto *context = benchmark_model();
+    if (not context) {
+        state.SkipWithError("Cannot load the whisper model, see WORKER_BENCHMARK_MODEL");
+        return;
+    }
+
+    auto const &pcm = benchmark_pcm();
+    if (pcm.empty()) {
+        state.SkipWithError("Cannot decode the benchmark media");
+        return;
+    }
+
+    // The profile gets all cores, as if it ran on the only whisper state
+    auto const profile = static_cast<transcriber::Profile>(state.range(0));
+    auto params = profile_params(profile, std::max(1u, std::thread::hardware_concurrency()));
+    params.language = nullptr;
+    params.translate = false;
+    params.print_progress = false;
+    params.print_realtime = false;
+
+    auto *whisper_state = whisper_init_state(context);
+    std::string transcript;
+    f64 seconds = 0.0;
+    for (auto _: state) {
+        transcript.clear();
+        auto const started = std::chrono::steady_clock::now();
+        for (usize offset = 0; offset < pcm.size(); offset += WINDOW_SIZE) {
+            auto const count = std::min(WINDOW_SIZE, pcm.size() - offset);
+            if (whisper_full_with_state(context, whisper_state, params, pcm.data() + offset, static_cast<int>(count)) !=
+                0) {
+                state.SkipWithError("Failed to process audio");
+                break;
+            }
+            for (int i = 0; i < whisper_full_n_segments_from_state(whisper_state); ++i) {
+                transcript += whisper_full_get_segment_text_from_state(whisper_state, i);
+            }
+        }
+        seconds += std::chrono::duration<f64>(std::chrono::steady_clock::now() - started).count();
+    }
+    whisper_free_state(whisper_state);
+
+    auto const audio_seconds = static_cast<f64>(pcm.size()) / SAMPLE_RATE;
+    state.counters["realtime_factor"] = seconds / static_cast<f64>(state.iterations()) / audio_seconds;
+    if (not reference_transcript().empty()) {
+        state.counters["wer"] = word_error_rate(reference_transcript(), transcript);
+    }
+}
+BENCHMARK(BM_Profile)
+        ->ArgName("profile")
+        ->Arg(transcriber::PROFILE_FAST)
+        ->Arg(transcriber::PROFILE_BALANCED)
+        ->Arg(transcriber::PROFILE_ACCURATE)
+        ->Iterations(1)
+        ->Unit(benchmark::kSecond)
+        ->UseRealTime();
@@ -0,0 +1,126 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include "resample.h"
+
+extern "C" {
+#include <libswresample/swresample.h>
+}
+
+namespace {
+
+// The input is converted in frames of this size, which is what common audio decoders produce
+constexpr usize FRAME_SIZE = 1024;
+
+// The length of the input
+constexpr usize SECONDS = 10;
+
+/**
+ * Generates interleaved stereo s16 samples of a sweep
+ * @param rate The sample rate
+ * @return The samples
+ */
+std::vector<s16> generate_input(int const rate) {
+    auto const frames = SECONDS * static_cast<usize>(rate);
+    std::vector<s16> samples(2 * frames);
+    for (usize i = 0; i < frames; ++i) {
+        auto const t = static_cast<f64>(i) / rate;
+        auto const sample = static_cast<s16>(12000.0 * std::sin(2.0 * std::numbers::pi * (100.0 + 300.0 * t) * t));
+        samples[2 * i] = sample;
+        samples[2 * i + 1] = static_cast<s16>(sample / 2);
+    }
+    return samples;
+}
+
+}// anonymous namespace
+
+/**
+ * Converts stereo s16 input to 16 kHz mono s16 with the FastResampler, just as the decoder does. The first
+ * argument is the input sample rate, the second whether the vectorized kernels are used.
+ */
+static void BM_FastResampler(benchmark::State &state) {
+    auto const rate = static_cast<int>(state.range(0));
+    auto const input = generate_input(rate);
+    auto const frames = input.size() / 2;
+
+    std::vector<f32> converted;
+    std::vector<s16> output;
+    for (auto _: state) {
+        auto resampler = FastResampler::create(SampleLayout::S16, rate, 2, state.range(1) != 0);
+        for (usize offset = 0; offset < frames; offset += FRAME_SIZE) {
+            u8 const *data[] = { reinterpret_cast<u8 const *>(input.data() + 2 * offset) };
+            converted.clear();
+            resampler->process(data, std::min(FRAME_SIZE, frames - offset), converted);
+            output.resize(converted.size());
+            convert_f32_to_s16(converted.data(), converted.size(), output.data());
+            benchmark::DoNotOptimize(output.data());
+        }
+    }
+    state.SetItemsProcessed(static_cast<s64>(state.iterations() * frames));
+}
+BENCHMARK(BM_FastResampler)
+        ->ArgNames({ "rate", "vectorized" })
+        ->ArgsProduct({ { 48000, 44100 }, { 0, 1 } })
+        ->Unit(benchmark::kMillisecond);
+
+/**
+ * Converts stereo s16 input to 16 kHz mono s16 with swresample, configured as in the decoder. The argument
+ * is the input sample rate.
+ */
+static void BM_Swresample(benchmark::State &state) {
+    auto const rate = static_cast<int>(state.range(0));
+    auto const input = generate_input(rate);
+    auto const frames = input.size() / 2;
+
+    std::vector<s16> output;
+    for (auto _: state) {
+        SwrContext *swr_ctx = nullptr;
+        constexpr AVChannelLayout in_layout = AV_CHANNEL_LAYOUT_STEREO;
+        constexpr AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
+        if (swr_alloc_set_opts2(&swr_ctx, &out_layout, AV_SAMPLE_FMT_S16, 16000, &in_layout, AV_SAMPLE_FMT_S16, rate,
+                                0, nullptr) < 0 or
+            swr_init(swr_ctx) < 0) {
+            swr_free(&swr_ctx);
+            state.SkipWithError("Could not configure SwrContext.");
+            return;
+        }
+
+        for (usize offset = 0; offset < frames; offset += FRAME_SIZE) {
+            auto const count = static_cast<int>(std::min(FRAME_SIZE, frames - offset));
+            output.resize(static_cast<usize>(swr_get_out_samples(swr_ctx, count)));
+            auto *out = reinterpret_cast<u8 *>(output.data());
+            auto const *in = reinterpret_cast<u8 const *>(input.data() + 2 * offset);
+            benchmark::DoNotOptimize(swr_convert(swr_ctx, &out, static_cast<int>(output.size()), &in, count));
+        }
+        swr_free(&swr_ctx);
+    }
+    state.SetItemsProcessed(static_cast<s64>(state.iterations() * frames));
+}
+BENCHMARK(BM_Swresample)->ArgName("rate")->Arg(48000)->Arg(44100)->Unit(benchmark::kMillisecond);
@@ -24,6 +24,24 @@ CPMAddPackage(
         VERSION 3.11.3
 )
 
+if (WORKER_BUILD_TESTS)
+    CPMAddPackage(
+            NAME googletest
+            GITHUB_REPOSITORY google/googletest
+            VERSION 1.15.2
+            OPTIONS "INSTALL_GTEST OFF" "BUILD_GMOCK OFF"
+    )
+endif ()
+
+if (WORKER_BUILD_BENCHMARKS)
+    CPMAddPackage(
+            NAME benchmark
+            GITHUB_REPOSITORY google/benchmark
+            VERSION 1.9.1
+            OPTIONS "BENCHMARK_ENABLE_TESTING OFF" "BENCHMARK_ENABLE_INSTALL OFF"
+    )
+endif ()
+
 find_package(PkgConfig REQUIRED)
 pkg_check_modules(AVFORMAT REQUIRED libavformat)
 pkg_check_modules(AVCODEC REQUIRED libavcodec)
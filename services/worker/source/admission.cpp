@@ -0,0 +1,233 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "admission.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// How often waiting requests check whether they were cancelled
+constexpr auto CANCEL_POLL_INTERVAL = std::chrono::seconds{ 1 };
+
+// The retry hint before any transcription finished, and the bounds of the hint
+constexpr auto DEFAULT_RETRY_AFTER = std::chrono::seconds{ 30 };
+constexpr auto MIN_RETRY_AFTER = std::chrono::seconds{ 1 };
+constexpr auto MAX_RETRY_AFTER = std::chrono::seconds{ 3600 };
+
+// The weight of the latest transcription in the moving average of their duration
+constexpr f64 AVERAGE_WEIGHT = 0.2;
+
+// Users weigh at least this much, so their requests are admitted eventually
+constexpr f64 MIN_WEIGHT = 0.01;
+
+}// anonymous namespace
+
+AdmissionQueue::Ticket::Ticket(AdmissionQueue *queue, u64 const id)
+    : m_queue{ queue },
+      m_id{ id },
+      m_admitted{ false } { }
+
+AdmissionQueue::Ticket::Ticket(Ticket &&other) noexcept
+    : m_queue{ std::exchange(other.m_queue, nullptr) },
+      m_id{ other.m_id },
+      m_user{ std::move(other.m_user) },
+      m_admitted{ other.m_admitted },
+      m_admitted_at{ other.m_admitted_at } { }
+
+AdmissionQueue::Ticket &AdmissionQueue::Ticket::operator=(Ticket &&other) noexcept {
+    if (this != &other) {
+        release();
+        m_queue = std::exchange(other.m_queue, nullptr);
+        m_id = other.m_id;
+        m_user = std::move(other.m_user);
+        m_admitted = other.m_admitted;
+        m_admitted_at = other.m_admitted_at;
+    }
+    return *this;
+}
+
+AdmissionQueue::Ticket::~Ticket() {
+    release();
+}
+
+bool AdmissionQueue::Ticket::wait(std::string const &user,
+                                  f64 const weight,
+                                  std::function<void(usize)> const &report,
+                                  std::function<bool()> const &cancelled) {
+    if (m_admitted) {
+        return true;
+    }
+
+    auto &queue = *m_queue;
+    usize reported = 0;
+    std::unique_lock lock{ queue.m_mutex };
+    auto const waiting = std::ranges::find(queue.m_waiting, m_id, &Waiting::id);
+    waiting->user = user;
+    waiting->weight = std::max(weight, MIN_WEIGHT);
+    waiting->ready = true;
+    m_user = user;
+
+    while (true) {
+        // The tickets that are first in order take the free places
+        auto const index = queue.rank(m_id);
+        auto const free = queue.m_max_active - std::min(queue.m_active, queue.m_max_active);
+        if (index < free) {
+            std::erase_if(queue.m_waiting, [this](Waiting const &entry) { return entry.id == m_id; });
+            ++queue.m_active;
+            ++queue.m_active_users[m_user];
+            m_admitted = true;
+            m_admitted_at = std::chrono::steady_clock::now();
+            queue.m_changed.notify_all();
+            return true;
+        }
+
+        if (auto const position = index - free + 1; position != reported) {
+            reported = position;
+            lock.unlock();
+            report(position);
+            lock.lock();
+            continue;
+        }
+
+        queue.m_changed.wait_for(lock, CANCEL_POLL_INTERVAL);
+
+        lock.unlock();
+        auto const stop = cancelled();
+        lock.lock();
+        if (stop) {
+            return false;
+        }
+    }
+}
+
+f64 AdmissionQueue::Ticket::expected_wait() const {
+    if (m_admitted) {
+        return 0.0;
+    }
+
+    auto const &queue = *m_queue;
+    std::lock_guard lock{ queue.m_mutex };
+    auto const ahead = static_cast<usize>(
+            std::ranges::count_if(queue.m_waiting, [this](Waiting const &entry) { return entry.id < m_id; }));
+    auto const free = queue.m_max_active - std::min(queue.m_active, queue.m_max_active);
+    if (ahead < free) {
+        return 0.0;
+    }
+
+    // Every active transcription frees its place after about the average duration, the earlier ones go first
+    auto const rounds = static_cast<f64>(ahead - free + 1) / static_cast<f64>(queue.m_max_active);
+    return queue.m_average_seconds * rounds;
+}
+
+void AdmissionQueue::Ticket::release() {
+    if (not m_queue) {
+        return;
+    }
+
+    auto &queue = *m_queue;
+    {
+        std::lock_guard lock{ queue.m_mutex };
+        if (m_admitted) {
+            auto const seconds = std::chrono::duration<f64>(std::chrono::steady_clock::now() - m_admitted_at).count();
+            queue.m_average_seconds = queue.m_average_seconds == 0.0
+                                              ? seconds
+                                              : (1.0 - AVERAGE_WEIGHT) * queue.m_average_seconds +
+                                                        AVERAGE_WEIGHT * seconds;
+            --queue.m_active;
+            if (auto const active = queue.m_active_users.find(m_user); --active->second == 0) {
+                queue.m_active_users.erase(active);
+            }
+        } else {
+            std::erase_if(queue.m_waiting, [this](Waiting const &entry) { return entry.id == m_id; });
+        }
+    }
+    queue.m_changed.notify_all();
+    m_queue = nullptr;
+}
+
+AdmissionQueue::AdmissionQueue(usize const max_active, usize const max_queued)
+    : m_max_active{ std::max<usize>(max_active, 1) },
+      m_max_queued{ max_queued },
+      m_active{ 0 },
+      m_next_id{ 0 },
+      m_average_seconds{ 0.0 } { }
+
+std::optional<AdmissionQueue::Ticket> AdmissionQueue::enter() {
+    std::lock_guard lock{ m_mutex };
+    if (m_active + m_waiting.size() >= capacity()) {
+        return std::nullopt;
+    }
+
+    auto const id = m_next_id++;
+    m_waiting.push_back(Waiting{ .id = id, .user = {}, .weight = 1.0, .ready = false });
+    return Ticket{ this, id };
+}
+
+usize AdmissionQueue::rank(u64 const id) const {
+    // Every waiting ticket is ranked by the active and earlier waiting transcriptions of its user per weight,
+    // so the users take turns. The sort is stable, hence tickets of the same rank keep their arrival order.
+    std::vector<std::pair<f64, u64>> order;
+    std::unordered_map<std::string, usize> ahead;
+    for (auto const &waiting: m_waiting) {
+        if (not waiting.ready) {
+            continue;
+        }
+
+        auto const active = m_active_users.contains(waiting.user) ? m_active_users.at(waiting.user) : 0;
+        auto const earlier = ahead[waiting.user]++;
+        order.emplace_back(static_cast<f64>(active + earlier) / waiting.weight, waiting.id);
+    }
+
+    std::ranges::stable_sort(order, {}, &std::pair<f64, u64>::first);
+    return static_cast<usize>(std::ranges::find(order, id, &std::pair<f64, u64>::second) - order.begin());
+}
+
+std::chrono::seconds AdmissionQueue::retry_after() const {
+    std::lock_guard lock{ m_mutex };
+    if (m_average_seconds == 0.0) {
+        return DEFAULT_RETRY_AFTER;
+    }
+
+    // Every active transcription frees its place after about the average duration, the waiting ones go first
+    auto const rounds = static_cast<f64>(m_waiting.size() + 1) / static_cast<f64>(m_max_active);
+    auto const seconds = std::chrono::seconds{ static_cast<s64>(std::ceil(m_average_seconds * rounds)) };
+    return std::clamp(seconds, MIN_RETRY_AFTER, MAX_RETRY_AFTER);
+}
+
+usize AdmissionQueue::capacity() const {
+    return m_max_active + m_max_queued;
+}
+
+usize AdmissionQueue::active() const {
+    std::lock_guard lock{ m_mutex };
+    return m_active;
+}
+
+usize AdmissionQueue::queued() const {
+    std::lock_guard lock{ m_mutex };
+    return m_waiting.size();
+}
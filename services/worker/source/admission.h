@@ -0,0 +1,169 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "types.h"
+
+/**
+ * The AdmissionQueue limits how many transcriptions are active at once and how many wait for their turn.
+ * Requests beyond both limits are rejected right away, so a burst of requests fails fast instead of buffering
+ * every upload in memory. Waiting requests of users with fewer active transcriptions relative to their weight
+ * are admitted first, otherwise they are admitted in the order they arrived.
+ */
+class AdmissionQueue {
+public:
+    /**
+     * A place in the queue, which is given up on destruction
+     */
+    class Ticket {
+    public:
+        Ticket(Ticket &&other) noexcept;
+        Ticket &operator=(Ticket &&other) noexcept;
+        ~Ticket();
+
+        Ticket(Ticket const &) = delete;
+        Ticket &operator=(Ticket const &) = delete;
+
+        /**
+         * Waits until the ticket is admitted
+         * @param user The user that initiated the request
+         * @param weight The share of the user relative to other users, 1 by default
+         * @param report Called with the position in the queue whenever it changes, 1 is next in line
+         * @param cancelled Whether the request was cancelled meanwhile, it is polled while waiting
+         * @return Whether the ticket was admitted, false if the request was cancelled
+         */
+        bool wait(std::string const &user,
+                  f64 weight,
+                  std::function<void(usize)> const &report,
+                  std::function<bool()> const &cancelled);
+
+        /**
+         * Estimates how long the ticket waits until it is admitted, from the duration of recent transcriptions.
+         * The ticket is not ranked before its user is known, so the tickets that arrived earlier count as ahead.
+         * @return The expected wait in seconds, 0 if a place is free or no transcription finished yet
+         */
+        [[nodiscard]] f64 expected_wait() const;
+
+    private:
+        friend class AdmissionQueue;
+
+        Ticket(AdmissionQueue *queue, u64 id);
+
+        /**
+         * Gives up the place in the queue
+         */
+        void release();
+
+        AdmissionQueue *m_queue;
+        u64 m_id;
+        std::string m_user;
+        bool m_admitted;
+        std::chrono::steady_clock::time_point m_admitted_at;
+    };
+
+    /**
+     * Creates the queue
+     * @param max_active The amount of transcriptions that are active at once
+     * @param max_queued The amount of transcriptions that wait for their turn
+     */
+    AdmissionQueue(usize max_active, usize max_queued);
+
+    AdmissionQueue(AdmissionQueue const &) = delete;
+    AdmissionQueue &operator=(AdmissionQueue const &) = delete;
+
+    /**
+     * Takes a place in the queue
+     * @return The ticket, or nothing if the queue is full
+     */
+    [[nodiscard]] std::optional<Ticket> enter();
+
+    /**
+     * Estimates when a place in the queue is free again, from the duration of recent transcriptions
+     * @return The time after which a rejected request should be retried
+     */
+    [[nodiscard]] std::chrono::seconds retry_after() const;
+
+    /**
+     * The amount of transcriptions that are active or wait, at most
+     * @return The capacity of the queue
+     */
+    [[nodiscard]] usize capacity() const;
+
+    /**
+     * The amount of active transcriptions
+     * @return The amount of active transcriptions
+     */
+    [[nodiscard]] usize active() const;
+
+    /**
+     * The amount of transcriptions that wait for their turn
+     * @return The amount of waiting transcriptions
+     */
+    [[nodiscard]] usize queued() const;
+
+private:
+    /**
+     * A ticket that is not admitted yet
+     */
+    struct Waiting {
+        u64 id;
+        std::string user;
+        f64 weight;
+
+        // Whether the ticket waits already, tickets are only ordered once their user is known
+        bool ready;
+    };
+
+    /**
+     * The order in which the waiting tickets are admitted, called with the lock held
+     * @param id The ticket whose rank is determined
+     * @return The amount of waiting tickets that are admitted before the ticket
+     */
+    [[nodiscard]] usize rank(u64 id) const;
+
+    usize m_max_active;
+    usize m_max_queued;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<Waiting> m_waiting;
+    std::unordered_map<std::string, usize> m_active_users;
+    usize m_active;
+    u64 m_next_id;
+
+    // The moving average of how long transcriptions were active, 0 until the first one finished
+    f64 m_average_seconds;
+};
+
+#endif// ADMISSION_H
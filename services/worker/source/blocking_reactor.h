@@ -0,0 +1,159 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef BLOCKING_REACTOR_H
+#define BLOCKING_REACTOR_H
+
+#include <condition_variable>
+#include <mutex>
+
+#include <grpcpp/grpcpp.h>
+
+/**
+ * The BlockingWriteReactor serves a server streaming call of the callback API to a thread that writes the
+ * responses one after another, as with the synchronous API. Only the writing thread waits for the writes,
+ * no gRPC thread is occupied by the call. The reactor deletes itself once the call is done.
+ * @tparam Response The type of the responses
+ */
+template<typename Response>
+class BlockingWriteReactor final : public grpc::ServerWriteReactor<Response> {
+public:
+    /**
+     * Writes a response and waits until it is sent
+     * @param response The response
+     * @return Whether the response was sent, false if the call is broken
+     */
+    bool Write(Response const &response) {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_writing = true;
+        }
+
+        // The reaction may run before StartWrite returns, so the lock must not be held meanwhile
+        this->StartWrite(&response);
+
+        std::unique_lock lock{ m_mutex };
+        m_written.wait(lock, [this] { return not m_writing; });
+        return m_write_ok;
+    }
+
+    void OnWriteDone(bool const ok) override {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_writing = false;
+            m_write_ok = ok;
+        }
+        m_written.notify_all();
+    }
+
+    void OnDone() override {
+        delete this;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_written;
+    bool m_writing = false;
+    bool m_write_ok = false;
+};
+
+/**
+ * The BlockingBidiReactor serves a bidirectional streaming call of the callback API to threads that read
+ * the requests and write the responses one after another, as with the synchronous API. One thread may read
+ * while another thread writes. The reactor deletes itself once the call is done.
+ * @tparam Request The type of the requests
+ * @tparam Response The type of the responses
+ */
+template<typename Request, typename Response>
+class BlockingBidiReactor final : public grpc::ServerBidiReactor<Request, Response> {
+public:
+    /**
+     * Reads the next request and waits until it arrived
+     * @param request The request that is read into
+     * @return Whether a request was read, false if the caller finished writing or the call is broken
+     */
+    bool Read(Request *request) {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_reading = true;
+        }
+
+        // The reaction may run before StartRead returns, so the lock must not be held meanwhile
+        this->StartRead(request);
+
+        std::unique_lock lock{ m_mutex };
+        m_read.wait(lock, [this] { return not m_reading; });
+        return m_read_ok;
+    }
+
+    /**
+     * Writes a response and waits until it is sent
+     * @param response The response
+     * @return Whether the response was sent, false if the call is broken
+     */
+    bool Write(Response const &response) {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_writing = true;
+        }
+
+        this->StartWrite(&response);
+
+        std::unique_lock lock{ m_mutex };
+        m_written.wait(lock, [this] { return not m_writing; });
+        return m_write_ok;
+    }
+
+    void OnReadDone(bool const ok) override {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_reading = false;
+            m_read_ok = ok;
+        }
+        m_read.notify_all();
+    }
+
+    void OnWriteDone(bool const ok) override {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_writing = false;
+            m_write_ok = ok;
+        }
+        m_written.notify_all();
+    }
+
+    void OnDone() override {
+        delete this;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_read;
+    std::condition_variable m_written;
+    bool m_reading = false;
+    bool m_read_ok = false;
+    bool m_writing = false;
+    bool m_write_ok = false;
+};
+
+#endif// BLOCKING_REACTOR_H
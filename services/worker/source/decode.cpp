@@ -22,9 +22,14 @@
 //  SOFTWARE.
 
 #include "decode.h"
+#include "resample.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
-#include <fstream>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <vector>
 
 // FFMPEG headers for decoding, format parsing, and resampling
@@ -41,23 +46,96 @@ enum {
     AVIO_BUFFER_SIZE = 0x1000// Custom I/O buffer size (4096 bytes)
 };
 
+// Seeking lands before a segment by this many seconds, so the decoder and resampler are primed at the segment start
+constexpr f64 SEGMENT_PREROLL = 0.5;
+
+// The output of segmented decoding has room for this many seconds more than the container duration
+constexpr f64 SEGMENT_TAIL_RESERVE = 1.0;
+
+// Probing limits for audio-only mode, the defaults are 5 MB and 5 seconds to detect video parameters
+constexpr s64 AUDIO_PROBE_SIZE = 1024 * 1024;
+constexpr s64 AUDIO_ANALYZE_DURATION = 2 * AV_TIME_BASE;
+
+// Segments shorter than this many seconds are not worth an additional decoder
+constexpr f64 MIN_SEGMENT_DURATION = 60.0;
+
+// Compressed audio takes at least this many bytes per second (4 kbit/s). The output of segmented decoding is sized
+// by the container duration, which is not trusted if it is longer than the input could possibly hold.
+constexpr f64 MIN_BYTES_PER_SECOND = 500.0;
+
 namespace {
 
-// Helper class that wraps custom I/O from a std::vector<u8> into an AVIOContext
+/**
+ * Rounds up to the next multiple of step, which also holds for negative values
+ * @param value The value
+ * @param step The step, which must be positive
+ * @return The smallest multiple of step that is not less than value
+ */
+s64 round_up(s64 const value, s64 const step) {
+    return (value / step + (value % step > 0 ? 1 : 0)) * step;
+}
+
+/**
+ * Maps the sample format of a decoder to a layout supported by the fast resampler
+ * @param format The sample format
+ * @return The layout, or nothing if the fast resampler does not support the format
+ */
+std::optional<SampleLayout> sample_layout(AVSampleFormat const format) {
+    switch (format) {
+        case AV_SAMPLE_FMT_S16:
+            return SampleLayout::S16;
+        case AV_SAMPLE_FMT_S16P:
+            return SampleLayout::S16P;
+        case AV_SAMPLE_FMT_FLT:
+            return SampleLayout::F32;
+        case AV_SAMPLE_FMT_FLTP:
+            return SampleLayout::F32P;
+        default:
+            return std::nullopt;
+    }
+}
+
+// Checks whether the format context contains an audio stream whose parameters are sufficient for decoding
+bool has_complete_audio_stream(AVFormatContext const *fmt_ctx) {
+    for (unsigned i = 0; i < fmt_ctx->nb_streams; ++i) {
+        auto const *codecpar = fmt_ctx->streams[i]->codecpar;
+        if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO and codecpar->codec_id != AV_CODEC_ID_NONE and
+            codecpar->sample_rate > 0 and codecpar->ch_layout.nb_channels > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Discards all streams except the kept one, streams of unknown type are kept as they may turn out to be audio
+void discard_streams(AVFormatContext const *fmt_ctx, int const keep) {
+    for (unsigned i = 0; i < fmt_ctx->nb_streams; ++i) {
+        auto *stream = fmt_ctx->streams[i];
+        if (stream->index == keep) {
+            continue;
+        }
+
+        if (keep >= 0 or (stream->codecpar->codec_type != AVMEDIA_TYPE_AUDIO and
+                          stream->codecpar->codec_type != AVMEDIA_TYPE_UNKNOWN)) {
+            stream->discard = AVDISCARD_ALL;
+        }
+    }
+}
+
+// Helper class that wraps custom I/O from a MediaSource into an AVIOContext
 class IOContext {
 public:
-    explicit IOContext(std::vector<uint8_t> input)
-        : m_input(std::move(input)),
-          m_position(0),
+    explicit IOContext(MediaSource &source)
+        : m_source(source),
           m_buffer(static_cast<uint8_t *>(av_malloc(AVIO_BUFFER_SIZE))),
           m_context(nullptr) {
         if (not m_buffer) {
             throw std::bad_alloc();// Allocation failed for AVIO buffer
         }
 
-        // Allocate AVIO context with our read and seek callbacks
-        m_context =
-                avio_alloc_context(m_buffer, AVIO_BUFFER_SIZE, 0, this, &IOContext::read, nullptr, &IOContext::seek);
+        // Allocate AVIO context with our read and seek callbacks, non-seekable sources get no seek callback
+        m_context = avio_alloc_context(m_buffer, AVIO_BUFFER_SIZE, 0, this, &IOContext::read, nullptr,
+                                       source.seekable() ? &IOContext::seek : nullptr);
 
         if (not m_context) {
             av_free(m_buffer);// Cleanup on failure
@@ -78,166 +156,231 @@ public:
     }
 
 private:
-    // Static callback for FFmpeg to read from our input buffer
+    // Static callback for FFmpeg to read from our media source
     static int read(void *opaque, uint8_t *buf, int const buf_size) {
         auto *io = static_cast<IOContext *>(opaque);
-        auto const remaining = io->m_input.size() - io->m_position;
-        auto const to_copy = std::min(static_cast<size_t>(buf_size), remaining);
-        if (to_copy == 0) {
+        auto const read = io->m_source.read(buf, static_cast<usize>(buf_size));
+        if (read == 0) {
             return AVERROR_EOF;
         }
 
-        std::memcpy(buf, io->m_input.data() + io->m_position, to_copy);
-        io->m_position += to_copy;
-        return static_cast<int>(to_copy);
+        return static_cast<int>(read);
     }
 
-    // Static callback for FFmpeg to seek in our buffer
+    // Static callback for FFmpeg to seek in our media source
     static int64_t seek(void *opaque, int64_t const offset, int const whence) {
         auto *io = static_cast<IOContext *>(opaque);
 
-        size_t new_pos = 0;
-        switch (whence) {
-            case SEEK_SET:
-                new_pos = static_cast<size_t>(offset);
-                break;
-            case SEEK_CUR:
-                new_pos = static_cast<size_t>(static_cast<int64_t>(io->m_position) + offset);
-                break;
-            case SEEK_END:
-                new_pos = static_cast<size_t>(static_cast<int64_t>(io->m_input.size()) + offset);
-                break;
-            case AVSEEK_SIZE:
-                return static_cast<int64_t>(io->m_input.size());
-            default:
-                return AVERROR(EINVAL);
+        if (whence == AVSEEK_SIZE) {
+            return io->m_source.size();
         }
 
-        if (new_pos > io->m_input.size()) {
-            return AVERROR(EINVAL);
+        if (auto const new_pos = io->m_source.seek(offset, whence & ~AVSEEK_FORCE); new_pos >= 0) {
+            return new_pos;
         }
-
-        io->m_position = new_pos;
-        return static_cast<int64_t>(new_pos);
+        return AVERROR(EINVAL);
     }
 
-    std::vector<uint8_t> m_input;
-    size_t m_position;
+    MediaSource &m_source;
     uint8_t *m_buffer;
     AVIOContext *m_context;
 };
 
 }// anonymous namespace
 
-// Main decoding function
-Result<std::vector<f32>> decode_pcm32(std::vector<u8> const &buffer) {
-    IOContext const context{ buffer };
+/**
+ * The Decoder holds all FFmpeg state of a PcmStream as well as the samples
+ * that were decoded, but not yet handed out as a window.
+ */
+struct PcmStream::Decoder {
+    Decoder() = default;
 
+    explicit Decoder(MediaSource &source) {
+        io.emplace(source);
+    }
+
+    explicit Decoder(std::unique_ptr<MediaSource> source) : owned_source{ std::move(source) } {
+        io.emplace(*owned_source);
+    }
+
+    ~Decoder() {
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        swr_free(&swr_ctx);
+        avcodec_free_context(&codec_ctx);
+        avformat_close_input(&fmt_ctx);
+    }
+
+    Decoder(Decoder const &) = delete;
+    Decoder &operator=(Decoder const &) = delete;
+
+    /**
+     * Opens the input, the decoder and the resampler
+     * @param options The decode options
+     * @return Nothing on success, the reason otherwise
+     */
+    Result<void> open(DecodeOptions const &options);
+
+    /**
+     * Demuxes and decodes the next packet, flushes the decoder at the end of the input
+     */
+    void decode_more();
+
+    /**
+     * Converts a decoded frame and appends the samples to the pending samples in 16 bit PCM
+     * @param f The decoded frame, nullptr flushes the resampler
+     * @param skip The amount of samples at the start of the frame that are not converted
+     */
+    void resample_and_store(AVFrame const *f, int skip = 0);
+
+    /**
+     * The duration of the opened input
+     * @return The duration in seconds, or 0 if it is unknown
+     */
+    [[nodiscard]] f64 duration() const;
+
+    /**
+     * Decodes the output samples in the range [begin, end) of an opened input. The output sample
+     * positions are derived from the frame timestamps and the resampler starts on an input sample
+     * that lies on the output sample grid. Once the preroll before the range primed the decoder and
+     * the resampler, adjacent ranges decoded by different decoders stitch together sample-accurately.
+     * @param begin The position of the first output sample
+     * @param end The position after the last output sample, or the maximum to decode until the end
+     * @param out Receives the first samples of the range
+     * @param overflow Receives the samples of the range that do not fit into out
+     * @return The amount of samples in the range
+     */
+    Result<usize> decode_range(s64 begin, s64 end, std::span<s16> out, std::vector<s16> &overflow);
+
+    std::unique_ptr<MediaSource> owned_source;
+    std::optional<IOContext> io;
+    AVFormatContext *fmt_ctx = nullptr;
+    AVCodecContext *codec_ctx = nullptr;
+    SwrContext *swr_ctx = nullptr;
+    std::unique_ptr<FastResampler> fast_resampler;
+    AVPacket *packet = nullptr;
+    AVFrame *frame = nullptr;
+    int audio_stream_index = -1;
+
+    // The resampled samples are kept as 16 bit PCM, the fast resampler's float output is staged in converted
+    std::vector<s16> pending;
+    std::vector<f32> converted;
+    usize offset = 0;
+    bool finished = false;
+
+    // Samples that were decoded before replace the pending samples, nothing is decoded then
+    std::unique_ptr<PcmSource> decoded;
+
+    // Receives every window that is handed out
+    std::function<void(std::span<s16 const>)> observer;
+};
+
+Result<void> PcmStream::Decoder::open(DecodeOptions const &options) {
     // Allocate and configure format context
-    AVFormatContext *fmt_ctx = avformat_alloc_context();
-    fmt_ctx->pb = context.native_handle();
+    fmt_ctx = avformat_alloc_context();
+    if (not fmt_ctx) {
+        return tl::unexpected("Could not allocate format context.");
+    }
+
+    fmt_ctx->pb = io->native_handle();
     fmt_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
 
-    // Open input using the custom IO context
+    // Detecting an audio stream needs far less probing than the defaults, which are tuned for video
+    if (options.audio_only) {
+        fmt_ctx->probesize = AUDIO_PROBE_SIZE;
+        fmt_ctx->max_analyze_duration = AUDIO_ANALYZE_DURATION;
+    }
+
+    // Open input using the custom IO context, the format context is freed on failure
     if (avformat_open_input(&fmt_ctx, nullptr, nullptr, nullptr) < 0) {
-        avformat_free_context(fmt_ctx);
         return tl::unexpected("Could not open input from buffer.");
     }
 
-    // Parse stream headers
-    if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
-        avformat_close_input(&fmt_ctx);
-        return tl::unexpected("Could not retrieve stream info.");
+    // Containers with a header (e.g. mp4, mkv) already describe their audio streams completely.
+    // In that case, probing the streams by decoding packets of every stream can be skipped.
+    if (not options.audio_only or not has_complete_audio_stream(fmt_ctx)) {
+        // Streams that are already known to be irrelevant are not decoded while probing
+        if (options.audio_only) {
+            discard_streams(fmt_ctx, -1);
+        }
+
+        // Parse stream headers
+        if (avformat_find_stream_info(fmt_ctx, nullptr) < 0) {
+            return tl::unexpected("Could not retrieve stream info.");
+        }
     }
 
     // Identify the best audio stream
-    auto const audio_stream_index = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    audio_stream_index = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
     if (audio_stream_index < 0) {
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("No audio stream found.");
     }
 
+    // The demuxer skips the packets of all other streams instead of reading them
+    if (options.audio_only) {
+        discard_streams(fmt_ctx, audio_stream_index);
+    }
+
     auto const *audio_stream = fmt_ctx->streams[audio_stream_index];
 
     // Find decoder for audio stream
     auto const *codec = avcodec_find_decoder(audio_stream->codecpar->codec_id);
     if (not codec) {
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("No suitable decoder found.");
     }
 
     // Allocate codec context
-    auto *codec_ctx = avcodec_alloc_context3(codec);
+    codec_ctx = avcodec_alloc_context3(codec);
     if (not codec_ctx) {
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("Could not allocate codec context.");
     }
 
     // Copy codec parameters into codec context
     if (avcodec_parameters_to_context(codec_ctx, audio_stream->codecpar) < 0) {
-        avcodec_free_context(&codec_ctx);
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("Could not copy codec parameters.");
     }
 
     // Open codec for decoding
     if (avcodec_open2(codec_ctx, codec, nullptr) < 0) {
-        avcodec_free_context(&codec_ctx);
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("Could not open codec.");
     }
 
-    // Initialize software resampler context for float mono output
-    auto *swr_ctx = swr_alloc();
-    if (not swr_ctx) {
-        avcodec_free_context(&codec_ctx);
-        avformat_close_input(&fmt_ctx);
-        return tl::unexpected("Could not allocate SwrContext.");
+    // The common formats are converted by the fast resampler, swresample handles everything else
+    if (options.fast_resample) {
+        if (auto const layout = sample_layout(codec_ctx->sample_fmt)) {
+            fast_resampler = FastResampler::create(*layout, codec_ctx->sample_rate, codec_ctx->ch_layout.nb_channels);
+        }
     }
 
-    constexpr AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
+    // Initialize software resampler context for 16 bit mono output
+    if (not fast_resampler) {
+        swr_ctx = swr_alloc();
+        if (not swr_ctx) {
+            return tl::unexpected("Could not allocate SwrContext.");
+        }
 
-    if (swr_alloc_set_opts2(&swr_ctx, &out_layout, AV_SAMPLE_FMT_FLT, WAVE_SAMPLE_RATE, &codec_ctx->ch_layout,
-                            codec_ctx->sample_fmt, codec_ctx->sample_rate, 0, nullptr) < 0 or
-        swr_init(swr_ctx) < 0) {
-        swr_free(&swr_ctx);
-        avcodec_free_context(&codec_ctx);
-        avformat_close_input(&fmt_ctx);
-        return tl::unexpected("Could not configure SwrContext.");
+        constexpr AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_MONO;
+
+        if (swr_alloc_set_opts2(&swr_ctx, &out_layout, AV_SAMPLE_FMT_S16, WAVE_SAMPLE_RATE, &codec_ctx->ch_layout,
+                                codec_ctx->sample_fmt, codec_ctx->sample_rate, 0, nullptr) < 0 or
+            swr_init(swr_ctx) < 0) {
+            return tl::unexpected("Could not configure SwrContext.");
+        }
     }
 
     // Prepare packet and frame containers
-    auto *packet = av_packet_alloc();
-    auto *frame = av_frame_alloc();
+    packet = av_packet_alloc();
+    frame = av_frame_alloc();
     if (not packet or not frame) {
-        av_packet_free(&packet);
-        av_frame_free(&frame);
-        swr_free(&swr_ctx);
-        avcodec_free_context(&codec_ctx);
-        avformat_close_input(&fmt_ctx);
         return tl::unexpected("Could not allocate AVPacket or AVFrame.");
     }
 
-    std::vector<f32> pcm_data;
-
-    // Lambda for converting and storing decoded frames
-    auto resample_and_store = [&](AVFrame const *f) {
-        auto const max_out_samples = swr_get_out_samples(swr_ctx, f->nb_samples);
-        if (max_out_samples <= 0)
-            return;
-
-        std::vector<f32> frame_buffer(max_out_samples);
-        auto *out_buf = reinterpret_cast<uint8_t *>(frame_buffer.data());
-
-        auto const **in_buf = const_cast<const uint8_t **>(f->data);
-        if (auto const converted_samples = swr_convert(swr_ctx, &out_buf, max_out_samples, in_buf, f->nb_samples);
-            converted_samples > 0) {
-            pcm_data.insert(pcm_data.end(), frame_buffer.begin(), frame_buffer.begin() + converted_samples);
-        }
-    };
+    return {};
+}
 
-    // Main decoding loop
-    while (av_read_frame(fmt_ctx, packet) >= 0) {
+void PcmStream::Decoder::decode_more() {
+    // Decode the next packet if it belongs to the audio stream
+    if (av_read_frame(fmt_ctx, packet) >= 0) {
         if (packet->stream_index == audio_stream_index) {
             if (avcodec_send_packet(codec_ctx, packet) == 0) {
                 while (avcodec_receive_frame(codec_ctx, frame) == 0) {
@@ -246,6 +389,7 @@ Result<std::vector<f32>> decode_pcm32(std::vector<u8> const &buffer) {
             }
         }
         av_packet_unref(packet);
+        return;
     }
 
     // Flush decoder
@@ -255,20 +399,360 @@ Result<std::vector<f32>> decode_pcm32(std::vector<u8> const &buffer) {
     }
 
     // Flush any remaining samples from resampler
-    if (auto const remaining = swr_get_out_samples(swr_ctx, 0); remaining > 0) {
-        std::vector<f32> flush_buffer(remaining);
-        auto *out_buf = reinterpret_cast<uint8_t *>(flush_buffer.data());
-        if (auto const flushed = swr_convert(swr_ctx, &out_buf, remaining, nullptr, 0); flushed > 0) {
-            pcm_data.insert(pcm_data.end(), flush_buffer.begin(), flush_buffer.begin() + flushed);
+    resample_and_store(nullptr);
+    finished = true;
+}
+
+void PcmStream::Decoder::resample_and_store(AVFrame const *f, int const skip) {
+    // Skipped samples are cut off the front of every plane of the frame
+    u8 const *const *data = f ? f->extended_data : nullptr;
+    auto const in_samples = f ? f->nb_samples - skip : 0;
+    std::vector<u8 const *> planes;
+    if (f and skip > 0) {
+        auto const format = static_cast<AVSampleFormat>(f->format);
+        auto const planar = av_sample_fmt_is_planar(format) != 0;
+        auto const channels = f->ch_layout.nb_channels;
+        auto const stride = av_get_bytes_per_sample(format) * (planar ? 1 : channels);
+        planes.resize(planar ? static_cast<usize>(channels) : 1);
+        for (usize i = 0; i < planes.size(); ++i) {
+            planes[i] = f->extended_data[i] + static_cast<ssize>(skip) * stride;
+        }
+        data = planes.data();
+    }
+
+    if (fast_resampler) {
+        if (f) {
+            fast_resampler->process(data, static_cast<usize>(in_samples), converted);
+        } else {
+            fast_resampler->flush(converted);
+        }
+
+        auto const offset = pending.size();
+        pending.resize(offset + converted.size());
+        convert_f32_to_s16(converted.data(), converted.size(), pending.data() + offset);
+        converted.clear();
+        return;
+    }
+
+    auto const max_out_samples = swr_get_out_samples(swr_ctx, in_samples);
+    if (max_out_samples <= 0) {
+        return;
+    }
+
+    // Convert directly into the pending samples, which keep their capacity across windows
+    auto const offset = pending.size();
+    pending.resize(offset + static_cast<usize>(max_out_samples));
+    auto *out_buf = reinterpret_cast<uint8_t *>(pending.data() + offset);
+
+    auto const **in_buf = const_cast<const uint8_t **>(data);
+    auto const converted_samples = swr_convert(swr_ctx, &out_buf, max_out_samples, in_buf, in_samples);
+    pending.resize(offset + static_cast<usize>(std::max(converted_samples, 0)));
+}
+
+f64 PcmStream::Decoder::duration() const {
+    if (fmt_ctx->duration != AV_NOPTS_VALUE and fmt_ctx->duration > 0) {
+        return static_cast<f64>(fmt_ctx->duration) / AV_TIME_BASE;
+    }
+
+    auto const *audio_stream = fmt_ctx->streams[audio_stream_index];
+    if (audio_stream->duration != AV_NOPTS_VALUE and audio_stream->duration > 0) {
+        return static_cast<f64>(audio_stream->duration) * av_q2d(audio_stream->time_base);
+    }
+    return 0.0;
+}
+
+Result<usize> PcmStream::Decoder::decode_range(s64 const begin,
+                                               s64 const end,
+                                               std::span<s16> const out,
+                                               std::vector<s16> &overflow) {
+    auto const *audio_stream = fmt_ctx->streams[audio_stream_index];
+    auto const time_base = av_q2d(audio_stream->time_base);
+    auto const start_time = audio_stream->start_time == AV_NOPTS_VALUE ? 0 : audio_stream->start_time;
+    auto const input_rate = codec_ctx->sample_rate;
+
+    // Input and output samples coincide every input_step input samples, e.g. every 441 samples of 44.1 kHz input
+    auto const divisor = std::gcd(input_rate, static_cast<int>(WAVE_SAMPLE_RATE));
+    auto const input_step = static_cast<s64>(input_rate / divisor);
+    auto const output_step = static_cast<s64>(WAVE_SAMPLE_RATE / divisor);
+
+    // Seek a bit before the range, so the decoder and resampler are primed once the first kept sample is reached
+    if (begin > 0) {
+        auto const seconds =
+                std::max(0.0, static_cast<f64>(begin) / static_cast<f64>(WAVE_SAMPLE_RATE) - SEGMENT_PREROLL);
+        auto const timestamp = start_time + static_cast<s64>(seconds / time_base);
+        if (av_seek_frame(fmt_ctx, audio_stream_index, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+            return tl::unexpected("Could not seek to segment.");
+        }
+    }
+
+    // The input position of the next decoded sample, which is known once the first frame is decoded
+    std::optional<s64> input_position;
+
+    // The input sample on which the resampler starts, and the output position of the first pending sample
+    s64 anchor = 0;
+    s64 position = 0;
+    usize count = 0;
+
+    // Appends samples of the range to the output
+    auto const emit = [&](s16 const *samples, usize const size) {
+        auto const offset = std::min(count, out.size());
+        auto const direct = std::min(size, out.size() - offset);
+        std::copy_n(samples, direct, out.data() + offset);
+        overflow.insert(overflow.end(), samples + direct, samples + size);
+        count += size;
+    };
+
+    // Only the resampled samples that lie inside the range are kept
+    auto const keep = [&] {
+        auto const pending_count = static_cast<s64>(pending.size());
+        auto const from = std::clamp<s64>(begin - position, 0, pending_count);
+        auto const to = std::clamp<s64>(end - position, 0, pending_count);
+        emit(pending.data() + from, static_cast<usize>(to - from));
+        position += pending_count;
+        pending.clear();
+    };
+
+    auto const store = [&](AVFrame const *f) -> Result<void> {
+        if (not input_position) {
+            if (f->best_effort_timestamp == AV_NOPTS_VALUE) {
+                return tl::unexpected("Decoded frame has no timestamp.");
+            }
+            input_position = av_rescale_q(f->best_effort_timestamp - start_time, audio_stream->time_base,
+                                          AVRational{ 1, input_rate });
+
+            // Samples before the next common sample of the input and output grid are dropped, so that the
+            // outputs of this resampler lie exactly on the positions of every other decoder of the input
+            anchor = round_up(*input_position, input_step);
+            position = anchor / input_step * output_step;
+            if (position > begin) {
+                // The first range starts with silence if the input does, any other range must start in its preroll
+                if (begin > 0) {
+                    return tl::unexpected("Seek landed after the segment start.");
+                }
+                std::vector<s16> const silence(static_cast<usize>(std::min(position, end) - begin), 0);
+                emit(silence.data(), silence.size());
+            }
+        }
+
+        auto const skip = std::clamp<s64>(anchor - *input_position, 0, f->nb_samples);
+        *input_position += f->nb_samples;
+        if (skip < f->nb_samples) {
+            resample_and_store(f, static_cast<int>(skip));
+            keep();
+        }
+        return {};
+    };
+
+    // Decode until the range is complete or the input ends
+    Result<void> stored;
+    auto eof = false;
+    while (stored and (not input_position or position < end)) {
+        if (av_read_frame(fmt_ctx, packet) < 0) {
+            eof = true;
+            break;
+        }
+
+        if (packet->stream_index == audio_stream_index) {
+            if (avcodec_send_packet(codec_ctx, packet) == 0) {
+                while (stored and avcodec_receive_frame(codec_ctx, frame) == 0) {
+                    stored = store(frame);
+                }
+            }
+        }
+        av_packet_unref(packet);
+    }
+
+    // At the end of the input, the decoder and resampler still hold samples
+    if (stored and eof) {
+        avcodec_send_packet(codec_ctx, nullptr);
+        while (stored and avcodec_receive_frame(codec_ctx, frame) == 0) {
+            stored = store(frame);
+        }
+
+        if (stored and input_position) {
+            resample_and_store(nullptr);
+            keep();
+        }
+    }
+
+    if (not stored) {
+        return tl::unexpected(stored.error());
+    }
+    return count;
+}
+
+PcmStream::PcmStream(std::unique_ptr<Decoder> decoder) : m_decoder{ std::move(decoder) } { }
+
+PcmStream::PcmStream(PcmStream &&) noexcept = default;
+
+PcmStream &PcmStream::operator=(PcmStream &&) noexcept = default;
+
+PcmStream::~PcmStream() = default;
+
+Result<PcmStream> PcmStream::open(MediaSource &source, DecodeOptions const &options) {
+    auto decoder = std::make_unique<Decoder>(source);
+    if (auto const opened = decoder->open(options); not opened) {
+        return tl::unexpected(opened.error());
+    }
+
+    return PcmStream{ std::move(decoder) };
+}
+
+Result<PcmStream> PcmStream::open_segmented(MediaSourceFactory const &factory,
+                                           utils::ThreadPool &pool,
+                                           usize const segments,
+                                           DecodeOptions const &options) {
+    // Probe the input first, this decoder also serves as the fallback for the sequential path
+    auto probe = std::make_unique<Decoder>(factory());
+    if (auto const opened = probe->open(options); not opened) {
+        return tl::unexpected(opened.error());
+    }
+
+    // Splitting the input requires random access and a known duration, short inputs are not worth splitting.
+    // A duration that the size of the input cannot hold, e.g. of a corrupt header, is decoded sequentially,
+    // which only allocates for the samples that are actually decoded.
+    auto const duration = probe->duration();
+    auto const size = probe->owned_source->size();
+    auto const count = std::min(segments, static_cast<usize>(duration / MIN_SEGMENT_DURATION));
+    if (not probe->owned_source->seekable() or count < 2 or size < 0 or
+        duration > static_cast<f64>(size) / MIN_BYTES_PER_SECOND) {
+        return PcmStream{ std::move(probe) };
+    }
+
+    // Every segment is decoded on its own decoder straight into its part of the output, the last segment
+    // decodes until the end of the input and may run a bit longer or shorter than the container claims
+    auto const total = static_cast<s64>(duration * static_cast<f64>(WAVE_SAMPLE_RATE));
+    std::vector<s16> samples;
+    auto const reserve = static_cast<s64>(SEGMENT_TAIL_RESERVE * static_cast<f64>(WAVE_SAMPLE_RATE));
+    samples.reserve(static_cast<usize>(total + reserve));
+    samples.resize(static_cast<usize>(total));
+    std::vector<s16> tail;
+
+    std::vector<std::future<Result<usize>>> futures;
+    futures.reserve(count);
+    auto last_begin = total;
+    for (usize i = 0; i < count; ++i) {
+        auto const last = i + 1 == count;
+        auto const begin = total * static_cast<s64>(i) / static_cast<s64>(count);
+        auto const end =
+                last ? std::numeric_limits<s64>::max() : total * static_cast<s64>(i + 1) / static_cast<s64>(count);
+        auto const out = std::span{ samples }.subspan(static_cast<usize>(begin),
+                                                      static_cast<usize>((last ? total : end) - begin));
+        last_begin = begin;
+
+        futures.push_back(pool.submit([&factory, &options, &tail, begin, end, out, last]() -> Result<usize> {
+            Decoder decoder{ factory() };
+            if (auto const opened = decoder.open(options); not opened) {
+                return tl::unexpected(opened.error());
+            }
+
+            // Only the last segment overflows its part of the output
+            std::vector<s16> unused;
+            auto const decoded = decoder.decode_range(begin, end, out, last ? tail : unused);
+            if (decoded and not last and *decoded != out.size()) {
+                return tl::unexpected("Segment ended before its range.");
+            }
+            return decoded;
+        }));
+    }
+
+    // All segments are waited for, as they write into the output. Any failed segment falls back to the sequential path.
+    std::vector<Result<usize>> decoded;
+    decoded.reserve(count);
+    for (auto &future : futures) {
+        decoded.push_back(future.get());
+    }
+
+    if (std::ranges::any_of(decoded, [](auto const &segment) { return not segment; })) {
+        return PcmStream{ std::move(probe) };
+    }
+
+    // The output ends where the last segment ended
+    samples.resize(std::min(samples.size(), static_cast<usize>(last_begin) + *decoded.back()));
+    samples.insert(samples.end(), tail.begin(), tail.end());
+
+    auto stitched = std::make_unique<Decoder>();
+    stitched->finished = true;
+    stitched->pending = std::move(samples);
+    return PcmStream{ std::move(stitched) };
+}
+
+PcmStream PcmStream::open_decoded(std::unique_ptr<PcmSource> source) {
+    auto decoder = std::make_unique<Decoder>();
+    decoder->decoded = std::move(source);
+    decoder->finished = true;
+    return PcmStream{ std::move(decoder) };
+}
+
+void PcmStream::observe(std::function<void(std::span<s16 const>)> observer) {
+    m_decoder->observer = std::move(observer);
+}
+
+f64 PcmStream::duration() const {
+    auto const &decoder = *m_decoder;
+    if (decoder.decoded) {
+        return static_cast<f64>(decoder.decoded->samples().size()) / static_cast<f64>(WAVE_SAMPLE_RATE);
+    }
+
+    // Inputs that were decoded in segments hold all of their samples already
+    if (not decoder.fmt_ctx) {
+        return static_cast<f64>(decoder.pending.size()) / static_cast<f64>(WAVE_SAMPLE_RATE);
+    }
+    return decoder.duration();
+}
+
+std::span<s16 const> PcmStream::peek(usize const size) {
+    auto &decoder = *m_decoder;
+    if (decoder.decoded) {
+        auto const samples = decoder.decoded->samples().subspan(decoder.offset);
+        return samples.first(std::min(size, samples.size()));
+    }
+
+    // The samples are kept pending, the next windows hand them out before decoding any further
+    while (decoder.pending.size() - decoder.offset < size and not decoder.finished) {
+        decoder.decode_more();
+    }
+
+    auto const count = std::min(size, decoder.pending.size() - decoder.offset);
+    return std::span<s16 const>{ decoder.pending.data() + decoder.offset, count };
+}
+
+std::span<s16 const> PcmStream::next_window(usize const size) {
+    auto &decoder = *m_decoder;
+
+    // Decoded samples are handed out in place
+    if (decoder.decoded) {
+        auto const samples = decoder.decoded->samples().subspan(decoder.offset);
+        auto const window = samples.first(std::min(size, samples.size()));
+        decoder.offset += window.size();
+        if (decoder.observer) {
+            decoder.observer(window);
+        }
+        return window;
+    }
+
+    // Decode only as much as necessary to fill the window
+    if (decoder.pending.size() - decoder.offset < size and not decoder.finished) {
+        // Drop the samples of the previous windows, only the remainder of the last decoded frame is kept
+        decoder.pending.erase(decoder.pending.begin(), decoder.pending.begin() + static_cast<ssize>(decoder.offset));
+        decoder.pending.reserve(size);
+        decoder.offset = 0;
+
+        while (decoder.pending.size() < size and not decoder.finished) {
+            decoder.decode_more();
         }
     }
 
-    // Free resources
-    av_packet_free(&packet);
-    av_frame_free(&frame);
-    swr_free(&swr_ctx);
-    avcodec_free_context(&codec_ctx);
-    avformat_close_input(&fmt_ctx);
+    auto const count = std::min(size, decoder.pending.size() - decoder.offset);
+    std::span<s16 const> const window{ decoder.pending.data() + decoder.offset, count };
+    decoder.offset += count;
+    if (decoder.observer) {
+        decoder.observer(window);
+    }
+    return window;
+}
 
-    return pcm_data;
-}
\ No newline at end of file
+void pcm_to_f32(std::span<s16 const> const pcm, std::vector<f32> &out) {
+    out.resize(pcm.size());
+    convert_s16_to_f32(pcm.data(), pcm.size(), out.data());
+}
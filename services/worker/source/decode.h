@@ -24,14 +24,165 @@
 #ifndef DECODE_H
 #define DECODE_H
 
+#include <functional>
+#include <memory>
+#include <span>
 #include <vector>
 #include "types.h"
+#include "utils/thread_pool.h"
 
 /**
- * Decodes the given buffer to pcm32
- * @param buffer The input buffer, which may be a video/audio file
- * @return PCM32 samples in float format
+ * A MediaSource provides the encoded bytes of a media file to the decoder.
+ * Sources that cannot seek are decoded strictly sequentially, which requires
+ * a streamable container (e.g. mkv, webm, mp3, wav, ogg or fragmented mp4).
  */
-[[nodiscard]] Result<std::vector<f32>> decode_pcm32(std::vector<u8> const &buffer);
+struct MediaSource {
+    virtual ~MediaSource() = default;
+
+    /**
+     * Reads up to size bytes into the buffer, blocking until data is available
+     * @param buffer The destination buffer
+     * @param size The maximum amount of bytes to read
+     * @return The amount of bytes read, 0 indicates the end of the source
+     */
+    [[nodiscard]] virtual usize read(u8 *buffer, usize size) = 0;
+
+    /**
+     * Moves the read position of the source
+     * @param offset The offset relative to whence
+     * @param whence One of SEEK_SET, SEEK_CUR or SEEK_END
+     * @return The new absolute position or -1 if the position is invalid
+     */
+    [[nodiscard]] virtual ssize seek(ssize offset, int whence) = 0;
+
+    /**
+     * The total size of the source
+     * @return The size in bytes or -1 if the size is not known
+     */
+    [[nodiscard]] virtual ssize size() const = 0;
+
+    /**
+     * Whether the source supports random access via seek
+     * @return True if seeking is supported
+     */
+    [[nodiscard]] virtual bool seekable() const = 0;
+};
+
+/**
+ * A PcmSource provides 16 kHz mono 16 bit PCM samples that were decoded before,
+ * e.g. a memory-mapped cache file, so the media does not have to be decoded again.
+ */
+struct PcmSource {
+    virtual ~PcmSource() = default;
+
+    /**
+     * The decoded samples, which stay valid as long as the source exists
+     * @return The samples
+     */
+    [[nodiscard]] virtual std::span<s16 const> samples() const = 0;
+};
+
+/**
+ * Options that control how media is demuxed and decoded
+ */
+struct DecodeOptions {
+    // Only the audio stream is probed and demuxed, packets of all other streams are skipped.
+    // This also limits the probing of the input to what is necessary to detect audio streams.
+    bool audio_only = true;
+
+    // Mono or stereo s16/flt input at 48 kHz, 44.1 kHz or 16 kHz is converted by the
+    // vectorized fast path instead of swresample.
+    bool fast_resample = true;
+};
+
+/**
+ * Creates independent media sources over the same media, used to decode segments in parallel
+ */
+using MediaSourceFactory = std::function<std::unique_ptr<MediaSource>()>;
+
+/**
+ * The PcmStream decodes a media source incrementally. Only as much of the source
+ * is decoded and resampled as the next window requires, hence the memory usage
+ * is bounded by the window size instead of the length of the media.
+ */
+class PcmStream {
+public:
+    PcmStream(PcmStream &&) noexcept;
+    PcmStream &operator=(PcmStream &&) noexcept;
+    ~PcmStream();
+
+    /**
+     * Opens a PCM stream on the given media source
+     * @param source The media source, which must outlive the stream
+     * @param options The decode options
+     * @return The stream or an error if the source cannot be decoded
+     */
+    [[nodiscard]] static Result<PcmStream> open(MediaSource &source, DecodeOptions const &options = {});
+
+    /**
+     * Decodes the whole media in parallel segments and opens a PCM stream on the result.
+     * The timeline is split into seek ranges that are decoded on their own decoders in the
+     * thread pool and stitched together at sample-accurate boundaries. Unlike open, this
+     * holds the PCM of the whole media in memory. Inputs that are not seekable, have an
+     * unknown duration or fail to decode in segments are decoded sequentially instead.
+     * @param factory Creates the media sources for the segments, must outlive the stream
+     * @param pool The thread pool on which the segments are decoded
+     * @param segments The maximum amount of segments
+     * @param options The decode options
+     * @return The stream or an error if the media cannot be decoded
+     */
+    [[nodiscard]] static Result<PcmStream> open_segmented(MediaSourceFactory const &factory,
+                                                          utils::ThreadPool &pool,
+                                                          usize segments,
+                                                          DecodeOptions const &options = {});
+
+    /**
+     * Opens a PCM stream on samples that were decoded before, the windows are handed out without copying
+     * @param source The decoded samples
+     * @return The stream
+     */
+    [[nodiscard]] static PcmStream open_decoded(std::unique_ptr<PcmSource> source);
+
+    /**
+     * Registers an observer that receives every window before it is handed out, e.g. to spill the PCM to disk
+     * @param observer The observer, which replaces a previously registered one
+     */
+    void observe(std::function<void(std::span<s16 const>)> observer);
+
+    /**
+     * The duration of the media, which is taken from the container unless the samples were decoded upfront
+     * @return The duration in seconds, or 0 if it is unknown
+     */
+    [[nodiscard]] f64 duration() const;
+
+    /**
+     * Decodes ahead without handing out a window, e.g. to inspect the start of the media. The samples are
+     * handed out by the next windows as usual, the observer only receives them then.
+     * @param size The amount of samples to decode ahead
+     * @return The next size samples, fewer only at the end of the media. They stay valid until the next window.
+     */
+    [[nodiscard]] std::span<s16 const> peek(usize size);
+
+    /**
+     * Decodes the next window of 16 bit PCM samples, see pcm_to_f32 for the conversion to float
+     * @param size The maximum amount of samples in the window
+     * @return Up to size samples, which stay valid until the next call. An empty window marks the end.
+     */
+    [[nodiscard]] std::span<s16 const> next_window(usize size);
+
+private:
+    struct Decoder;
+
+    explicit PcmStream(std::unique_ptr<Decoder> decoder);
+
+    std::unique_ptr<Decoder> m_decoder;
+};
+
+/**
+ * Converts a window of 16 bit PCM samples to float samples, as expected by whisper
+ * @param pcm The 16 bit PCM samples
+ * @param out The float samples, resized to the size of the window
+ */
+void pcm_to_f32(std::span<s16 const> pcm, std::vector<f32> &out);
 
 #endif// DECODE_H
@@ -0,0 +1,357 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "fingerprint.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+// The PCM is downsampled from 16 kHz to 4 kHz, which keeps the bands of the fingerprint
+constexpr usize DOWNSAMPLING = 4;
+constexpr f32 SAMPLE_RATE = 16000.0f / DOWNSAMPLING;
+
+// Frames of 256 ms every 64 ms, the long frames keep the sub-fingerprints stable if the audio is shifted
+constexpr usize FRAME_SIZE = 1024;
+constexpr usize HOP_SIZE = 256;
+
+// 33 logarithmically spaced bands between 300 Hz and 2 kHz yield 32 bits per frame
+constexpr usize BANDS = 33;
+constexpr f32 MIN_FREQUENCY = 300.0f;
+constexpr f32 MAX_FREQUENCY = 2000.0f;
+
+// One in this many distinct sub-fingerprints is indexed, chosen by their value so a query selects the same ones
+constexpr u32 SAMPLING = 16;
+
+// Fingerprints shorter than this (about 4 seconds) are too ambiguous to be matched
+constexpr usize MIN_FRAMES = 64;
+
+// Matching fingerprints overlap in at least this share of both of their lengths
+constexpr f64 MIN_COVERAGE = 0.95;
+
+// Candidates need at least this many equal sub-fingerprints at the same offset, only the best ones are verified
+constexpr u32 MIN_VOTES = 2;
+constexpr usize MAX_CANDIDATES = 4;
+
+// The bit error rate is verified in blocks of about 8 seconds, so audio that shares most of its content but
+// differs in one part is not matched because of the parts that agree
+constexpr usize BLOCK_FRAMES = 128;
+
+/**
+ * Whether a sub-fingerprint is part of the index. Silence yields sub-fingerprints without information.
+ * @param value The sub-fingerprint
+ * @return Whether the sub-fingerprint is indexed
+ */
+bool sampled(u32 const value) {
+    return value != 0 and value != ~0u and ((value * 0x9E3779B1u) >> 24) % SAMPLING == 0;
+}
+
+}// anonymous namespace
+
+Fingerprinter::Fingerprinter()
+    : m_offset{ 0 },
+      m_group_sum{ 0.0f },
+      m_group_size{ 0 },
+      m_real(FRAME_SIZE),
+      m_imag(FRAME_SIZE),
+      m_cos(FRAME_SIZE / 2),
+      m_sin(FRAME_SIZE / 2),
+      m_reversed(FRAME_SIZE),
+      m_window(FRAME_SIZE),
+      m_band_edges(BANDS + 1) {
+    auto const bits = std::countr_zero(FRAME_SIZE);
+    for (usize i = 0; i < FRAME_SIZE; ++i) {
+        m_reversed[i] = 0;
+        for (auto bit = 0; bit < bits; ++bit) {
+            m_reversed[i] |= static_cast<u32>((i >> bit) & 1) << (bits - 1 - bit);
+        }
+        m_window[i] = 0.5f - 0.5f * std::cos(2.0f * std::numbers::pi_v<f32> * static_cast<f32>(i) / FRAME_SIZE);
+    }
+
+    for (usize i = 0; i < FRAME_SIZE / 2; ++i) {
+        auto const angle = -2.0f * std::numbers::pi_v<f32> * static_cast<f32>(i) / FRAME_SIZE;
+        m_cos[i] = std::cos(angle);
+        m_sin[i] = std::sin(angle);
+    }
+
+    for (usize band = 0; band <= BANDS; ++band) {
+        auto const frequency =
+                MIN_FREQUENCY * std::pow(MAX_FREQUENCY / MIN_FREQUENCY, static_cast<f32>(band) / BANDS);
+        m_band_edges[band] = static_cast<usize>(std::lround(frequency * FRAME_SIZE / SAMPLE_RATE));
+    }
+}
+
+void Fingerprinter::feed(std::span<s16 const> const pcm) {
+    for (auto const sample: pcm) {
+        m_group_sum += static_cast<f32>(sample);
+        if (++m_group_size == DOWNSAMPLING) {
+            m_signal.push_back(m_group_sum / (DOWNSAMPLING * 32768.0f));
+            m_group_sum = 0.0f;
+            m_group_size = 0;
+        }
+    }
+
+    while (m_signal.size() - m_offset >= FRAME_SIZE) {
+        process_frame();
+        m_offset += HOP_SIZE;
+    }
+
+    // Drop the processed part of the signal once in a while
+    if (m_offset >= 8 * FRAME_SIZE) {
+        m_signal.erase(m_signal.begin(), m_signal.begin() + static_cast<ssize>(m_offset));
+        m_offset = 0;
+    }
+}
+
+Fingerprint Fingerprinter::finish() {
+    auto fingerprint = std::move(m_fingerprint);
+    m_fingerprint.clear();
+    m_signal.clear();
+    m_previous.clear();
+    m_offset = 0;
+    m_group_sum = 0.0f;
+    m_group_size = 0;
+    return fingerprint;
+}
+
+usize Fingerprinter::frames(usize const samples) {
+    // The first frame has no predecessor and yields no sub-fingerprint
+    auto const signal = samples / DOWNSAMPLING;
+    return signal < FRAME_SIZE ? 0 : (signal - FRAME_SIZE) / HOP_SIZE;
+}
+
+void Fingerprinter::process_frame() {
+    // Iterative radix-2 FFT of the windowed frame
+    auto const *frame = m_signal.data() + m_offset;
+    for (usize i = 0; i < FRAME_SIZE; ++i) {
+        m_real[m_reversed[i]] = frame[i] * m_window[i];
+    }
+    std::ranges::fill(m_imag, 0.0f);
+
+    for (usize length = 2; length <= FRAME_SIZE; length <<= 1) {
+        auto const half = length / 2;
+        auto const step = FRAME_SIZE / length;
+        for (usize start = 0; start < FRAME_SIZE; start += length) {
+            for (usize i = 0; i < half; ++i) {
+                auto const even = start + i;
+                auto const odd = even + half;
+                auto const real = m_real[odd] * m_cos[i * step] - m_imag[odd] * m_sin[i * step];
+                auto const imag = m_real[odd] * m_sin[i * step] + m_imag[odd] * m_cos[i * step];
+                m_real[odd] = m_real[even] - real;
+                m_imag[odd] = m_imag[even] - imag;
+                m_real[even] += real;
+                m_imag[even] += imag;
+            }
+        }
+    }
+
+    std::array<f32, BANDS> energies{};
+    for (usize band = 0; band < BANDS; ++band) {
+        for (auto bin = m_band_edges[band]; bin < m_band_edges[band + 1]; ++bin) {
+            energies[band] += m_real[bin] * m_real[bin] + m_imag[bin] * m_imag[bin];
+        }
+    }
+
+    // Every bit is the sign of the change of the energy difference of adjacent bands since the previous frame
+    std::vector<f32> differences(BANDS - 1);
+    for (usize band = 0; band + 1 < BANDS; ++band) {
+        differences[band] = energies[band] - energies[band + 1];
+    }
+
+    if (not m_previous.empty()) {
+        u32 value = 0;
+        for (usize band = 0; band + 1 < BANDS; ++band) {
+            if (differences[band] - m_previous[band] > 0.0f) {
+                value |= 1u << band;
+            }
+        }
+        m_fingerprint.push_back(value);
+    }
+    m_previous = std::move(differences);
+}
+
+FingerprintIndex::FingerprintIndex(usize const capacity, f64 const max_bit_error_rate)
+    : m_capacity{ capacity },
+      m_max_bit_error_rate{ max_bit_error_rate },
+      m_next_entry{ 0 } { }
+
+bool FingerprintIndex::has_candidate(Fingerprint const &prefix,
+                                     std::string const &user,
+                                     std::string const &settings) {
+    if (prefix.size() < MIN_FRAMES) {
+        return false;
+    }
+
+    // The prefix must lie at the start of the transcribed audio
+    std::lock_guard lock{ m_mutex };
+    return std::ranges::any_of(candidates(prefix, user, settings), [](Candidate const &candidate) {
+        return static_cast<f64>(std::abs(candidate.offset)) <=
+               (1.0 - MIN_COVERAGE) * static_cast<f64>(candidate.entry->fingerprint.size());
+    });
+}
+
+std::optional<FingerprintMatch> FingerprintIndex::find(Fingerprint const &fingerprint,
+                                                       std::string const &user,
+                                                       std::string const &settings) {
+    if (fingerprint.size() < MIN_FRAMES) {
+        return std::nullopt;
+    }
+
+    std::lock_guard lock{ m_mutex };
+
+    // The candidates are verified on the bits where both fingerprints overlap, which must cover nearly all
+    // of both of them
+    std::optional<FingerprintMatch> match;
+    auto const size = static_cast<f64>(fingerprint.size());
+    for (auto const &[entry, offset]: candidates(fingerprint, user, settings)) {
+        auto const length = static_cast<f64>(entry->fingerprint.size());
+        auto const begin = std::max<s64>(0, -offset);
+        auto const end = std::min(static_cast<s64>(fingerprint.size()),
+                                  static_cast<s64>(entry->fingerprint.size()) - offset);
+        auto const overlap = static_cast<f64>(end - begin);
+        if (overlap < MIN_COVERAGE * size or overlap < MIN_COVERAGE * length) {
+            continue;
+        }
+
+        // Every block must agree on its own, a short last block is verified along with the previous one
+        u64 errors = 0;
+        auto agrees = true;
+        for (auto block = begin; block < end and agrees;) {
+            auto block_end = std::min(block + static_cast<s64>(BLOCK_FRAMES), end);
+            if (end - block_end < static_cast<s64>(BLOCK_FRAMES / 2)) {
+                block_end = end;
+            }
+
+            u64 block_errors = 0;
+            for (auto position = block; position < block_end; ++position) {
+                block_errors += std::popcount(fingerprint[position] ^ entry->fingerprint[position + offset]);
+            }
+            auto const bits = 32.0 * static_cast<f64>(block_end - block);
+            agrees = static_cast<f64>(block_errors) <= m_max_bit_error_rate * bits;
+            errors += block_errors;
+            block = block_end;
+        }
+
+        auto const bit_error_rate = static_cast<f64>(errors) / (32.0 * overlap);
+        if (agrees and (not match or bit_error_rate < match->bit_error_rate)) {
+            match = FingerprintMatch{ .segments = entry->segments, .bit_error_rate = bit_error_rate };
+        }
+    }
+    return match;
+}
+
+void FingerprintIndex::insert(Fingerprint fingerprint,
+                              std::string user,
+                              std::string settings,
+                              std::vector<std::string> segments) {
+    if (fingerprint.size() < MIN_FRAMES or m_capacity == 0) {
+        return;
+    }
+
+    std::lock_guard lock{ m_mutex };
+    while (m_entries.size() >= m_capacity) {
+        drop_oldest();
+    }
+
+    auto const id = m_next_entry++;
+    for (usize position = 0; position < fingerprint.size(); ++position) {
+        if (sampled(fingerprint[position])) {
+            m_postings[fingerprint[position]].push_back(Posting{ .entry = id, .position = static_cast<u32>(position) });
+        }
+    }
+
+    m_entries.emplace(id, Entry{ .fingerprint = std::move(fingerprint),
+                                 .user = std::move(user),
+                                 .settings = std::move(settings),
+                                 .segments = std::move(segments) });
+    m_order.push_back(id);
+}
+
+usize FingerprintIndex::size() {
+    std::lock_guard lock{ m_mutex };
+    return m_entries.size();
+}
+
+std::vector<FingerprintIndex::Candidate> FingerprintIndex::candidates(Fingerprint const &fingerprint,
+                                                                      std::string const &user,
+                                                                      std::string const &settings) const {
+    // Every equal sub-fingerprint votes for an entry at the offset between the two positions
+    std::unordered_map<u64, u32> votes;
+    for (usize position = 0; position < fingerprint.size(); ++position) {
+        if (not sampled(fingerprint[position])) {
+            continue;
+        }
+
+        auto const postings = m_postings.find(fingerprint[position]);
+        if (postings == m_postings.end()) {
+            continue;
+        }
+
+        for (auto const &posting: postings->second) {
+            auto const offset = static_cast<u32>(posting.position - static_cast<u32>(position));
+            ++votes[posting.entry << 32 | offset];
+        }
+    }
+
+    std::vector<std::pair<u64, u32>> voted;
+    for (auto const &[candidate, count]: votes) {
+        auto const &entry = m_entries.at(candidate >> 32);
+        if (count >= MIN_VOTES and entry.user == user and entry.settings == settings) {
+            voted.emplace_back(candidate, count);
+        }
+    }
+    auto const best = std::min(voted.size(), MAX_CANDIDATES);
+    std::ranges::partial_sort(voted, voted.begin() + static_cast<ssize>(best), std::greater{},
+                              [](auto const &candidate) { return candidate.second; });
+
+    std::vector<Candidate> result;
+    for (usize i = 0; i < best; ++i) {
+        result.push_back(Candidate{ .entry = &m_entries.at(voted[i].first >> 32),
+                                    .offset = static_cast<s32>(static_cast<u32>(voted[i].first)) });
+    }
+    return result;
+}
+
+void FingerprintIndex::drop_oldest() {
+    auto const id = m_order.front();
+    m_order.pop_front();
+
+    auto const entry = m_entries.find(id);
+    for (auto const value: entry->second.fingerprint) {
+        if (not sampled(value)) {
+            continue;
+        }
+
+        if (auto const postings = m_postings.find(value); postings != m_postings.end()) {
+            std::erase_if(postings->second, [id](Posting const &posting) { return posting.entry == id; });
+            if (postings->second.empty()) {
+                m_postings.erase(postings);
+            }
+        }
+    }
+    m_entries.erase(entry);
+}
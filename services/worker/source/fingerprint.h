@@ -0,0 +1,220 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+/**
+ * An acoustic fingerprint, one 32 bit sub-fingerprint per 64 ms of audio. Every bit encodes whether the
+ * energy difference of two adjacent frequency bands rises or falls over time, which survives re-encoding
+ * and changes of volume.
+ */
+using Fingerprint = std::vector<u32>;
+
+/**
+ * The Fingerprinter computes the fingerprint of 16 kHz mono PCM incrementally, window by window
+ */
+class Fingerprinter {
+public:
+    Fingerprinter();
+
+    /**
+     * Adds samples to the fingerprint
+     * @param pcm The next 16 kHz mono samples
+     */
+    void feed(std::span<s16 const> pcm);
+
+    /**
+     * Takes the fingerprint of all samples so far, the fingerprinter starts over afterwards
+     * @return The fingerprint
+     */
+    [[nodiscard]] Fingerprint finish();
+
+    /**
+     * The length of the fingerprint of the given amount of samples
+     * @param samples The amount of 16 kHz mono samples
+     * @return The amount of sub-fingerprints
+     */
+    [[nodiscard]] static usize frames(usize samples);
+
+private:
+    /**
+     * Computes the sub-fingerprint of the frame at the start of the signal
+     */
+    void process_frame();
+
+    // The signal downsampled to 4 kHz, the part before offset was already processed
+    std::vector<f32> m_signal;
+    usize m_offset;
+
+    // The downsampling averages groups of samples, the current group is incomplete
+    f32 m_group_sum;
+    usize m_group_size;
+
+    // The FFT of the frame and its precomputed tables
+    std::vector<f32> m_real;
+    std::vector<f32> m_imag;
+    std::vector<f32> m_cos;
+    std::vector<f32> m_sin;
+    std::vector<u32> m_reversed;
+    std::vector<f32> m_window;
+    std::vector<usize> m_band_edges;
+
+    // The band energy differences of the previous frame, empty for the first frame
+    std::vector<f32> m_previous;
+    Fingerprint m_fingerprint;
+};
+
+/**
+ * A transcript that was found through the fingerprint of its audio
+ */
+struct FingerprintMatch {
+    // The segments of the transcript
+    std::vector<std::string> segments;
+
+    // The share of differing bits where both fingerprints overlap
+    f64 bit_error_rate;
+};
+
+/**
+ * The FingerprintIndex holds the fingerprints of the most recent transcripts in memory, so the transcript of
+ * audio that arrives again in another encoding is reused. Candidates are found via exact matches of
+ * sub-fingerprints, of which only a content-defined sample is indexed, and are verified on their whole
+ * fingerprint. Only transcripts of nearly the same audio are matched, as transcripts carry no timestamps
+ * that would allow to cut them to a part of the audio. Transcripts are only ever matched for the user
+ * whose audio they transcribe.
+ */
+class FingerprintIndex {
+public:
+    /**
+     * Instantiates a new empty fingerprint index
+     * @param capacity The maximum amount of transcripts, the oldest ones are dropped first
+     * @param max_bit_error_rate The maximum share of differing bits of matching fingerprints
+     */
+    FingerprintIndex(usize capacity, f64 max_bit_error_rate);
+
+    /**
+     * Tells by the fingerprint of the start of the audio whether there may be a transcript of the same audio,
+     * so the whole audio is only fingerprinted if there is a candidate
+     * @param prefix The fingerprint of the start of the audio
+     * @param user The user the audio belongs to
+     * @param settings Identifies the settings that affect the transcript, e.g. the model and profile
+     * @return Whether find may return a transcript for the whole audio
+     */
+    [[nodiscard]] bool has_candidate(Fingerprint const &prefix, std::string const &user, std::string const &settings);
+
+    /**
+     * Looks up the transcript of the same audio. The fingerprints must be about as long as each other and
+     * must agree on every part of the audio, not only on average, so audio that merely shares its start
+     * or a jingle is not matched.
+     * @param fingerprint The fingerprint of the whole audio
+     * @param user The user the audio belongs to
+     * @param settings Identifies the settings that affect the transcript, e.g. the model and profile
+     * @return The matching transcript, or nothing if there is none
+     */
+    [[nodiscard]] std::optional<FingerprintMatch> find(Fingerprint const &fingerprint,
+                                                       std::string const &user,
+                                                       std::string const &settings);
+
+    /**
+     * Adds a transcript to the index, fingerprints that are too short to be matched reliably are ignored
+     * @param fingerprint The fingerprint of the audio
+     * @param user The user the audio belongs to
+     * @param settings Identifies the settings that affect the transcript, e.g. the model and profile
+     * @param segments The segments of the transcript
+     */
+    void insert(Fingerprint fingerprint, std::string user, std::string settings, std::vector<std::string> segments);
+
+    /**
+     * The amount of transcripts in the index
+     * @return The amount of transcripts
+     */
+    [[nodiscard]] usize size();
+
+private:
+    /**
+     * An indexed transcript
+     */
+    struct Entry {
+        Fingerprint fingerprint;
+        std::string user;
+        std::string settings;
+        std::vector<std::string> segments;
+    };
+
+    /**
+     * An occurrence of a sub-fingerprint
+     */
+    struct Posting {
+        u64 entry;
+        u32 position;
+    };
+
+    /**
+     * A candidate entry, i.e. a fingerprint that shares sub-fingerprints with the query at the same offset
+     */
+    struct Candidate {
+        Entry const *entry;
+        s64 offset;
+    };
+
+    /**
+     * Finds the entries of the user and settings that share the most sub-fingerprints with the query at the same
+     * offset, called with the lock held
+     * @param fingerprint The fingerprint of the query
+     * @param user The user the audio belongs to
+     * @param settings Identifies the settings that affect the transcript
+     * @return The best candidates, the most likely first
+     */
+    [[nodiscard]] std::vector<Candidate> candidates(Fingerprint const &fingerprint,
+                                                    std::string const &user,
+                                                    std::string const &settings) const;
+
+    /**
+     * Drops the oldest transcript, called with the lock held
+     */
+    void drop_oldest();
+
+    usize m_capacity;
+    f64 m_max_bit_error_rate;
+
+    std::mutex m_mutex;
+    std::unordered_map<u64, Entry> m_entries;
+    std::unordered_map<u32, std::vector<Posting>> m_postings;
+
+    // The IDs of the entries in insertion order, the oldest first
+    std::deque<u64> m_order;
+    u64 m_next_entry;
+};
+
+#endif// FINGERPRINT_H
@@ -49,6 +49,26 @@ static bool env_present(char const *env) {
     return std::getenv(env) != nullptr;
 }
 
+/**
+ * Parses the weights of users, which are given as comma separated pairs, e.g. "alice=2,bob=0.5"
+ * @param weights The weights
+ * @return The weight of every listed user
+ */
+static std::unordered_map<std::string, f64> parse_weights(std::string_view weights) {
+    std::unordered_map<std::string, f64> parsed;
+    while (not weights.empty()) {
+        auto const end = std::min(weights.find(','), weights.size());
+        auto const pair = weights.substr(0, end);
+        weights.remove_prefix(std::min(end + 1, weights.size()));
+
+        if (auto const separator = pair.find('='); separator != std::string_view::npos) {
+            parsed[std::string{ pair.substr(0, separator) }] =
+                    std::strtod(std::string{ pair.substr(separator + 1) }.c_str(), nullptr);
+        }
+    }
+    return parsed;
+}
+
 int main(int, char **) {
     spdlog::info("Starting transcriber server...");
 
@@ -68,25 +88,111 @@ int main(int, char **) {
     spdlog::info("Listen address: {}", listen_addr);
     spdlog::info("Persistence address: {}", persistence_addr);
 
+    // Decoding while the upload is still arriving only works for streamable containers, hence it is opt-in
+    TranscriberOptions transcriber_options;
+    transcriber_options.streaming_decode = env_present("TRANSCRIBER_STREAMING_DECODE");
+    transcriber_options.decode_threads = std::strtoull(env_or_default("TRANSCRIBER_DECODE_THREADS", "1"), nullptr, 10);
+    transcriber_options.decode.audio_only = not env_present("TRANSCRIBER_FULL_PROBE");
+    transcriber_options.decode.fast_resample = not env_present("TRANSCRIBER_SWRESAMPLE_ONLY");
+    transcriber_options.whisper_states = std::strtoull(env_or_default("WHISPER_POOL_SIZE", "1"), nullptr, 10);
+    transcriber_options.model_memory_budget =
+            std::strtoull(env_or_default("WHISPER_MODEL_MEMORY_BUDGET_MB", "0"), nullptr, 10) * 1024 * 1024;
+    transcriber_options.parallel_windows =
+            std::strtoull(env_or_default("TRANSCRIBER_PARALLEL_WINDOWS", "1"), nullptr, 10);
+    transcriber_options.boundary_tolerance_ms =
+            std::strtoull(env_or_default("TRANSCRIBER_BOUNDARY_TOLERANCE_MS", "2000"), nullptr, 10);
+    transcriber_options.adaptive_audio_ctx = env_present("TRANSCRIBER_ADAPTIVE_AUDIO_CTX");
+    transcriber_options.carry_context = not env_present("TRANSCRIBER_INDEPENDENT_WINDOWS");
+    if (env_present("TRANSCRIBER_VAD")) {
+        transcriber_options.voice_detector = [] { return std::make_unique<EnergyDetector>(); };
+    }
+    transcriber_options.transcript_cache_directory = env_or_default("TRANSCRIBER_CACHE_DIRECTORY", "");
+    transcriber_options.transcript_cache_capacity =
+            std::strtoull(env_or_default("TRANSCRIBER_CACHE_CAPACITY_MB", "1024"), nullptr, 10) * 1024 * 1024;
+    transcriber_options.pcm_cache_directory = env_or_default("TRANSCRIBER_PCM_CACHE_DIRECTORY", "");
+    transcriber_options.pcm_cache_capacity =
+            std::strtoull(env_or_default("TRANSCRIBER_PCM_CACHE_CAPACITY_MB", "4096"), nullptr, 10) * 1024 * 1024;
+    transcriber_options.fingerprint_capacity =
+            std::strtoull(env_or_default("TRANSCRIBER_FINGERPRINT_CAPACITY", "0"), nullptr, 10);
+    transcriber_options.fingerprint_max_bit_error_rate =
+            std::strtod(env_or_default("TRANSCRIBER_FINGERPRINT_MAX_BER", "0.25"), nullptr);
+    transcriber_options.segment_writer.queue_capacity =
+            std::strtoull(env_or_default("TRANSCRIBER_SEGMENT_QUEUE_CAPACITY", "1024"), nullptr, 10);
+    transcriber_options.segment_writer.batch_bytes =
+            std::strtoull(env_or_default("TRANSCRIBER_PERSISTENCE_BATCH_BYTES", "4096"), nullptr, 10);
+    transcriber_options.segment_writer.batch_delay = std::chrono::milliseconds{
+        std::strtoull(env_or_default("TRANSCRIBER_PERSISTENCE_BATCH_MS", "500"), nullptr, 10)
+    };
+    transcriber_options.request_threads =
+            std::strtoull(env_or_default("TRANSCRIBER_REQUEST_THREADS", "4"), nullptr, 10);
+    transcriber_options.queued_requests =
+            std::strtoull(env_or_default("TRANSCRIBER_QUEUE_CAPACITY", "16"), nullptr, 10);
+    transcriber_options.user_weights = parse_weights(env_or_default("TRANSCRIBER_USER_WEIGHTS", ""));
+    spdlog::info("Streaming decode: {}", transcriber_options.streaming_decode);
+    spdlog::info("Decode threads: {}", transcriber_options.decode_threads);
+    spdlog::info("Audio-only demux: {}", transcriber_options.decode.audio_only);
+    spdlog::info("Fast resampling: {}", transcriber_options.decode.fast_resample);
+    spdlog::info("Whisper pool size: {}", transcriber_options.whisper_states);
+    spdlog::info("Model memory budget: {} MiB", transcriber_options.model_memory_budget / (1024 * 1024));
+    spdlog::info("Parallel windows: {}", transcriber_options.parallel_windows);
+    spdlog::info("Window boundary tolerance: {} ms", transcriber_options.boundary_tolerance_ms);
+    spdlog::info("Adaptive audio context: {}", transcriber_options.adaptive_audio_ctx);
+    spdlog::info("Carry context across windows: {}", transcriber_options.carry_context);
+    spdlog::info("Voice activity detection: {}", static_cast<bool>(transcriber_options.voice_detector));
+    spdlog::info("Transcript cache directory: {}", transcriber_options.transcript_cache_directory.string());
+    spdlog::info("Transcript cache capacity: {} MiB", transcriber_options.transcript_cache_capacity / (1024 * 1024));
+    spdlog::info("PCM cache directory: {}", transcriber_options.pcm_cache_directory.string());
+    spdlog::info("PCM cache capacity: {} MiB", transcriber_options.pcm_cache_capacity / (1024 * 1024));
+    spdlog::info("Fingerprint capacity: {}", transcriber_options.fingerprint_capacity);
+    spdlog::info("Fingerprint max bit error rate: {}", transcriber_options.fingerprint_max_bit_error_rate);
+    spdlog::info("Segment queue capacity: {}", transcriber_options.segment_writer.queue_capacity);
+    spdlog::info("Persistence batch: {} bytes or {} ms", transcriber_options.segment_writer.batch_bytes,
+                 transcriber_options.segment_writer.batch_delay.count());
+    spdlog::info("Transcriber request threads: {}", transcriber_options.request_threads);
+    spdlog::info("Transcriber queue capacity: {}", transcriber_options.queued_requests);
+    for (auto const &[user, weight]: transcriber_options.user_weights) {
+        spdlog::info("Transcriber weight of user {}: {}", user, weight);
+    }
+
     // This creates a gRPC channel in order for the worker to call the persistence gRPC service.
     // Insecure credentials are used to avoid certificate setup
     auto const persistence_channel = CreateChannel(persistence_addr, grpc::InsecureChannelCredentials());
     std::shared_ptr const persistence_stub = persistence::Persistence::NewStub(persistence_channel);
 
+    // The chunks of all requests are multiplexed onto a few long-lived persistence streams
+    auto const persistence_streams = std::strtoull(env_or_default("PERSISTENCE_STREAMS", "2"), nullptr, 10);
+    spdlog::info("Persistence streams: {}", persistence_streams);
+
+    // Chunks are spooled to disk until persistence received them, so outages and restarts do not lose them
+    std::filesystem::path const spool_directory = env_or_default("PERSISTENCE_SPOOL_DIRECTORY", "");
+    std::chrono::milliseconds const spool_sync_interval{
+        std::strtoull(env_or_default("PERSISTENCE_SPOOL_SYNC_MS", "100"), nullptr, 10)
+    };
+    spdlog::info("Persistence spool directory: {}", spool_directory.string());
+    spdlog::info("Persistence spool sync interval: {} ms", spool_sync_interval.count());
+    auto spool = spool_directory.empty() ? nullptr
+                                         : std::make_unique<PersistenceSpool>(spool_directory, spool_sync_interval);
+    auto const persistence =
+            std::make_shared<PersistenceSessions>(persistence_stub, persistence_streams, std::move(spool));
+
     // The ServerBuilder enables us to configure the gRPC server part of the worker
     grpc::ServerBuilder builder;
     builder.AddListeningPort(listen_addr, grpc::InsecureServerCredentials());
 
-    // The TranscriberService is configured with the whisper model path and persistence stub
+    // Both services use the callback API, the gRPC threads only dispatch the calls to the request pools of the
+    // services. Heartbeats are answered right away, even if every request thread is busy.
+    // The TranscriberService is configured with the whisper model path, persistence sessions and options
     // The model path is necessary for whisper to load its transcription context
-    // The persistence stub is necessary to communicate with the persistence gRPC service
-    TranscriberService transcriber_service{ model_path, persistence_stub };
+    // The persistence sessions are necessary to communicate with the persistence gRPC service
+    TranscriberService transcriber_service{ model_path, persistence, transcriber_options };
     builder.RegisterService(&transcriber_service);
 
     // The SummarizerService is configured with the OpenAI endpoint (which is in fact DeepSeek), the JWT token
-    // which is required for the endpoint and the persistence stub which is necessary to communicate with the
-    // persistence gRPC service.
-    SummarizerService summarizer_service{ openai_endpoint, jwt, persistence_stub };
+    // which is required for the endpoint and the persistence sessions which are necessary to communicate with the
+    // persistence gRPC service. The calls to the endpoint mostly wait for it, so more of them run at once.
+    auto const summarizer_threads = std::strtoull(env_or_default("SUMMARIZER_REQUEST_THREADS", "8"), nullptr, 10);
+    spdlog::info("Summarizer request threads: {}", summarizer_threads);
+    SummarizerService summarizer_service{ openai_endpoint, jwt, persistence, summarizer_threads };
     builder.RegisterService(&summarizer_service);
 
     // The gRPC server is built and started. This call does not return until the server is stopped.
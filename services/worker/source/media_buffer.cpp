@@ -0,0 +1,110 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "media_buffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+void MediaBuffer::append(std::string chunk) {
+    if (chunk.empty()) {
+        return;
+    }
+
+    m_offsets.push_back(m_size);
+    m_size += chunk.size();
+    m_chunks.push_back(std::move(chunk));
+}
+
+usize MediaBuffer::size() const {
+    return m_size;
+}
+
+bool MediaBuffer::empty() const {
+    return m_size == 0;
+}
+
+MediaBuffer::Reader::Reader(MediaBuffer const &buffer) : m_buffer{ buffer }, m_position{ 0 }, m_chunk{ 0 } { }
+
+usize MediaBuffer::Reader::read(u8 *buffer, usize const size) {
+    auto const &chunks = m_buffer.m_chunks;
+    auto const &offsets = m_buffer.m_offsets;
+
+    usize read = 0;
+    while (read < size and m_chunk < chunks.size()) {
+        // Copy from the current chunk, starting at the position relative to the chunk
+        auto const &chunk = chunks[m_chunk];
+        auto const chunk_offset = m_position - offsets[m_chunk];
+        auto const to_copy = std::min(size - read, chunk.size() - chunk_offset);
+        std::memcpy(buffer + read, chunk.data() + chunk_offset, to_copy);
+
+        read += to_copy;
+        m_position += to_copy;
+        if (chunk_offset + to_copy == chunk.size()) {
+            ++m_chunk;
+        }
+    }
+
+    return read;
+}
+
+ssize MediaBuffer::Reader::seek(ssize const offset, int const whence) {
+    ssize new_pos = 0;
+    switch (whence) {
+        case SEEK_SET:
+            new_pos = offset;
+            break;
+        case SEEK_CUR:
+            new_pos = static_cast<ssize>(m_position) + offset;
+            break;
+        case SEEK_END:
+            new_pos = static_cast<ssize>(m_buffer.m_size) + offset;
+            break;
+        default:
+            return -1;
+    }
+
+    if (new_pos < 0 or new_pos > static_cast<ssize>(m_buffer.m_size)) {
+        return -1;
+    }
+
+    // Locate the chunk that contains the new position, which is the last chunk starting at or before it
+    auto const &offsets = m_buffer.m_offsets;
+    auto const next = std::upper_bound(offsets.begin(), offsets.end(), static_cast<usize>(new_pos));
+    m_chunk = next == offsets.begin() ? 0 : static_cast<usize>(std::distance(offsets.begin(), next) - 1);
+    if (static_cast<usize>(new_pos) == m_buffer.m_size) {
+        m_chunk = offsets.size();
+    }
+
+    m_position = static_cast<usize>(new_pos);
+    return new_pos;
+}
+
+ssize MediaBuffer::Reader::size() const {
+    return static_cast<ssize>(m_buffer.m_size);
+}
+
+bool MediaBuffer::Reader::seekable() const {
+    return true;
+}
@@ -0,0 +1,87 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef MEDIA_BUFFER_H
+#define MEDIA_BUFFER_H
+
+#include <string>
+#include <vector>
+
+#include "decode.h"
+
+/**
+ * The MediaBuffer stores an upload as a rope of the received chunks.
+ * Chunks are moved in as they are received, so the upload is never flattened
+ * into one contiguous buffer. The decoder reads the buffer through a Reader,
+ * which supports random access without copying the chunks.
+ */
+class MediaBuffer {
+public:
+    /**
+     * A seekable read cursor over a MediaBuffer. Multiple readers may read
+     * the same buffer, as long as no more chunks are appended.
+     */
+    class Reader final : public MediaSource {
+    public:
+        /**
+         * Instantiates a new reader positioned at the start of the buffer
+         * @param buffer The buffer to read from
+         */
+        explicit Reader(MediaBuffer const &buffer);
+
+        [[nodiscard]] usize read(u8 *buffer, usize size) override;
+        [[nodiscard]] ssize seek(ssize offset, int whence) override;
+        [[nodiscard]] ssize size() const override;
+        [[nodiscard]] bool seekable() const override;
+
+    private:
+        MediaBuffer const &m_buffer;
+        usize m_position;
+        usize m_chunk;
+    };
+
+    /**
+     * Appends a chunk to the buffer
+     * @param chunk The chunk, which is moved into the buffer
+     */
+    void append(std::string chunk);
+
+    /**
+     * The total size of all chunks
+     * @return The size in bytes
+     */
+    [[nodiscard]] usize size() const;
+
+    /**
+     * Whether the buffer contains no data
+     * @return True if the buffer is empty
+     */
+    [[nodiscard]] bool empty() const;
+
+private:
+    std::vector<std::string> m_chunks;
+    std::vector<usize> m_offsets;
+    usize m_size = 0;
+};
+
+#endif// MEDIA_BUFFER_H
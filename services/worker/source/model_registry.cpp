@@ -0,0 +1,210 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "model_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <optional>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Model files are named after the whisper.cpp convention, e.g. ggml-tiny.bin
+constexpr std::string_view MODEL_PREFIX = "ggml-";
+constexpr std::string_view MODEL_EXTENSION = ".bin";
+
+/**
+ * Checks whether a model name only consists of characters that may appear in a model file name.
+ * This prevents requests from loading files outside of the model directory.
+ * @param name The name of the model
+ * @return Whether the name is valid
+ */
+bool valid_model_name(std::string const &name) {
+    auto const valid_character = [](char const c) {
+        return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9') or c == '-' or
+               c == '_' or c == '.';
+    };
+    return not name.empty() and name.find("..") == std::string::npos and std::ranges::all_of(name, valid_character);
+}
+
+}// anonymous namespace
+
+ModelRegistry::ModelRegistry(std::filesystem::path default_model_path, usize const states, usize const memory_budget)
+    : m_default_model_path{ std::move(default_model_path) },
+      m_default_model{ m_default_model_path.stem().string() },
+      m_states{ states },
+      m_memory_budget{ memory_budget },
+      m_memory{ 0 } {
+    // The default model is named like the other models, e.g. ggml-tiny.bin is the model "tiny"
+    if (m_default_model.starts_with(MODEL_PREFIX)) {
+        m_default_model.erase(0, MODEL_PREFIX.size());
+    }
+}
+
+Result<std::shared_ptr<WhisperPool>> ModelRegistry::acquire(std::string const &name) {
+    auto const &model = name.empty() ? m_default_model : name;
+    if (not valid_model_name(model)) {
+        return tl::unexpected(std::format("Invalid model name '{}'.", model));
+    }
+
+    std::promise<LoadResult> promise;
+    std::shared_future<LoadResult> pool;
+    std::optional<LoadResult> loaded_pool;
+    auto loading = false;
+    {
+        std::lock_guard lock{ m_mutex };
+        if (auto const entry = m_models.find(model); entry != m_models.end()) {
+            // Loaded or currently loading, either way the model becomes the most recently used one
+            m_recent.splice(m_recent.begin(), m_recent, entry->second.recent);
+            pool = entry->second.pool;
+
+            // A loaded model is handed out under the lock, so it is in use before the next eviction looks at it.
+            // A model that is still loading cannot be evicted as long as requests wait for it.
+            if (pool.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                loaded_pool = pool.get();
+            } else {
+                ++entry->second.waiters;
+            }
+        } else {
+            // Other requests for the same model wait for this load instead of loading the model again
+            // The weights occupy roughly the size of the model file, so room is made for them upfront
+            std::error_code error;
+            auto const file_size = std::filesystem::file_size(model_path(model), error);
+
+            m_recent.push_front(model);
+            pool = promise.get_future().share();
+            m_models.emplace(model, Entry{ .pool = pool,
+                                           .memory = error ? 0 : file_size,
+                                           .recent = m_recent.begin(),
+                                           .waiters = 0 });
+            m_memory += error ? 0 : file_size;
+            loading = true;
+        }
+
+        // Models that became idle since the last request are evicted if the budget is exceeded
+        evict(model);
+    }
+
+    if (loaded_pool) {
+        return std::move(*loaded_pool);
+    }
+
+    if (not loading) {
+        pool.wait();
+
+        // The waiting request takes its copy of the model under the lock as well. A failed load removes
+        // the entry, in which case the entry of this name is another load, if any.
+        std::lock_guard lock{ m_mutex };
+        if (auto const entry = m_models.find(model);
+            entry != m_models.end() and
+            entry->second.pool.wait_for(std::chrono::seconds::zero()) == std::future_status::ready and
+            &entry->second.pool.get() == &pool.get()) {
+            --entry->second.waiters;
+        }
+        return pool.get();
+    }
+
+    // The model is loaded without holding the lock, so requests for other models are not blocked
+    auto const started = std::chrono::steady_clock::now();
+    auto loaded = load(model);
+    promise.set_value(loaded);
+
+    std::lock_guard lock{ m_mutex };
+    auto const entry = m_models.find(model);
+    if (not loaded) {
+        // Failed loads are not cached, the next request tries again
+        m_memory -= entry->second.memory;
+        m_recent.erase(entry->second.recent);
+        m_models.erase(entry);
+        return loaded;
+    }
+
+    // Every state adds its buffers to the weights, as far as the resident memory of the process tells
+    auto const state_memory = (*loaded)->size() * (*loaded)->state_memory();
+    entry->second.memory += state_memory;
+    m_memory += state_memory;
+
+    auto const elapsed = std::chrono::duration<f64>(std::chrono::steady_clock::now() - started).count();
+    spdlog::info("Loaded model {} in {:.1f}s with {} states of approximately {} MiB each (about {} MiB, {} MiB loaded "
+                 "in total)",
+                 model, elapsed, (*loaded)->size(), (*loaded)->state_memory() / (1024 * 1024),
+                 entry->second.memory / (1024 * 1024), m_memory / (1024 * 1024));
+
+    evict(model);
+    return loaded;
+}
+
+std::string const &ModelRegistry::default_model() const {
+    return m_default_model;
+}
+
+std::filesystem::path ModelRegistry::model_path(std::string const &name) const {
+    if (name == m_default_model) {
+        return m_default_model_path;
+    }
+    return m_default_model_path.parent_path() / std::format("{}{}{}", MODEL_PREFIX, name, MODEL_EXTENSION);
+}
+
+ModelRegistry::LoadResult ModelRegistry::load(std::string const &name) const {
+    auto const path = model_path(name);
+    if (not std::filesystem::exists(path)) {
+        return tl::unexpected(std::format("Unknown model '{}'.", name));
+    }
+    auto pool = WhisperPool::create(path, m_states);
+    if (not pool) {
+        return tl::unexpected(pool.error());
+    }
+    return std::shared_ptr<WhisperPool>{ std::move(*pool) };
+}
+
+void ModelRegistry::evict(std::string const &keep) {
+    if (m_memory_budget == 0) {
+        return;
+    }
+
+    // Walk from the least recently used model, models that are loading or in use cannot be evicted
+    for (auto name = m_recent.end(); m_memory > m_memory_budget and name != m_recent.begin();) {
+        --name;
+        auto const entry = m_models.find(*name);
+        auto const &pool = entry->second.pool;
+        if (*name == keep or entry->second.waiters > 0 or
+            pool.wait_for(std::chrono::seconds::zero()) != std::future_status::ready or not pool.get() or
+            pool.get()->use_count() > 1) {
+            continue;
+        }
+
+        spdlog::info("Evicting idle model {} ({} MiB)", *name, entry->second.memory / (1024 * 1024));
+        m_memory -= entry->second.memory;
+        m_models.erase(entry);
+        name = m_recent.erase(name);
+    }
+
+    if (m_memory > m_memory_budget) {
+        spdlog::debug("Loaded models exceed the memory budget, all of them are in use ({} MiB loaded)",
+                     m_memory / (1024 * 1024));
+    }
+}
@@ -0,0 +1,116 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "types.h"
+#include "whisper_pool.h"
+
+/**
+ * The ModelRegistry loads whisper models on demand by their name, e.g. "tiny" for
+ * ggml-tiny.bin in the directory of the default model. The weights of a model are shared by all requests that use it.
+ * Once the loaded models exceed the memory budget, the least recently used models that
+ * are not in use by any request are evicted.
+ */
+class ModelRegistry {
+public:
+    /**
+     * Instantiates a new model registry, no model is loaded yet
+     * @param default_model_path The path to the model that is used if a request does not specify one,
+     *                           the other models are located in the same directory
+     * @param states The amount of whisper states of every model
+     * @param memory_budget The memory in bytes that the loaded models may occupy, 0 for no limit
+     */
+    ModelRegistry(std::filesystem::path default_model_path, usize states, usize memory_budget);
+
+    /**
+     * Retrieves a model, which is loaded if it is not loaded yet
+     * @param name The name of the model, empty for the default model
+     * @return The whisper pool of the model, which stays loaded as long as it is held, or an error
+     */
+    [[nodiscard]] Result<std::shared_ptr<WhisperPool>> acquire(std::string const &name);
+
+    /**
+     * The name of the default model
+     * @return The name of the model
+     */
+    [[nodiscard]] std::string const &default_model() const;
+
+private:
+    using LoadResult = Result<std::shared_ptr<WhisperPool>>;
+
+    /**
+     * A loaded model or a model that is currently being loaded
+     */
+    struct Entry {
+        std::shared_future<LoadResult> pool;
+        usize memory;
+        std::list<std::string>::iterator recent;
+
+        // The requests that wait for the model to be loaded, which have not taken their copy of it yet
+        usize waiters;
+    };
+
+    /**
+     * The path of the model file
+     * @param name The name of the model
+     * @return The path of the model file
+     */
+    [[nodiscard]] std::filesystem::path model_path(std::string const &name) const;
+
+    /**
+     * Loads a model, called without holding the lock
+     * @param name The name of the model
+     * @return The whisper pool of the model or an error
+     */
+    [[nodiscard]] LoadResult load(std::string const &name) const;
+
+    /**
+     * Evicts the least recently used idle models until the loaded models fit into the budget
+     * @param keep The name of the model that is currently requested, which is never evicted
+     */
+    void evict(std::string const &keep);
+
+    std::filesystem::path m_default_model_path;
+    std::string m_default_model;
+    usize m_states;
+    usize m_memory_budget;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_models;
+
+    // The names of the models, most recently used first
+    std::list<std::string> m_recent;
+    usize m_memory;
+};
+
+#endif// MODEL_REGISTRY_H
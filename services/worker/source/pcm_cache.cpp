@@ -0,0 +1,233 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "pcm_cache.h"
+
+#include <array>
+#include <cstring>
+#include <format>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Cached PCM is stored in files with this extension
+constexpr auto PCM_EXTENSION = ".pcm";
+
+// The PCM that is cached is what whisper expects
+constexpr u32 PCM_SAMPLE_RATE = 16000;
+constexpr u32 PCM_CHANNELS = 1;
+
+// Identifies the file format, the version changes whenever the layout changes
+constexpr std::array<char, 8> PCM_MAGIC = { 'S', 'G', 'P', 'C', 'M', '\0', '\0', '\0' };
+constexpr u32 PCM_VERSION = 1;
+
+/**
+ * The encoding of the samples in a cache file
+ */
+enum class PcmFormat : u32 {
+    S16 = 0,
+    F32 = 1,
+};
+
+/**
+ * The header of a cache file, the samples follow right after it
+ */
+struct PcmHeader {
+    std::array<char, 8> magic;
+    u32 version;
+    u32 sample_rate;
+    u32 channels;
+    PcmFormat format;
+    u64 samples;
+};
+
+// The header keeps the samples aligned when the file is mapped
+static_assert(sizeof(PcmHeader) == 32);
+
+/**
+ * Cached PCM that is mapped into memory, the mapping stays valid even if the file is evicted meanwhile
+ */
+class MappedPcm final : public PcmSource {
+public:
+    MappedPcm(void *mapping, usize const length, std::span<s16 const> const samples)
+        : m_mapping{ mapping },
+          m_length{ length },
+          m_samples{ samples } { }
+
+    ~MappedPcm() override {
+        munmap(m_mapping, m_length);
+    }
+
+    MappedPcm(MappedPcm const &) = delete;
+    MappedPcm &operator=(MappedPcm const &) = delete;
+
+    [[nodiscard]] std::span<s16 const> samples() const override {
+        return m_samples;
+    }
+
+private:
+    void *m_mapping;
+    usize m_length;
+    std::span<s16 const> m_samples;
+};
+
+/**
+ * Maps a cache file into memory and validates its header
+ * @param path The path of the file
+ * @return The mapped samples or the reason why the file cannot be used
+ */
+Result<std::unique_ptr<MappedPcm>> map_pcm(std::filesystem::path const &path) {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return tl::unexpected(std::format("Cannot open {}: {}", path.string(), std::strerror(errno)));
+    }
+
+    struct stat status{};
+    if (fstat(fd, &status) != 0 or static_cast<usize>(status.st_size) < sizeof(PcmHeader)) {
+        close(fd);
+        return tl::unexpected(std::format("{} is truncated.", path.string()));
+    }
+
+    auto const length = static_cast<usize>(status.st_size);
+    auto *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return tl::unexpected(std::format("Cannot map {}: {}", path.string(), std::strerror(errno)));
+    }
+
+    PcmHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (header.magic != PCM_MAGIC or header.version != PCM_VERSION or header.sample_rate != PCM_SAMPLE_RATE or
+        header.channels != PCM_CHANNELS or header.format != PcmFormat::S16 or
+        header.samples != (length - sizeof(PcmHeader)) / sizeof(s16)) {
+        munmap(mapping, length);
+        return tl::unexpected(std::format("{} has an invalid header.", path.string()));
+    }
+
+    // The windows are read front to back, so the kernel may read ahead aggressively
+    madvise(mapping, length, MADV_SEQUENTIAL);
+
+    auto const *samples = reinterpret_cast<s16 const *>(static_cast<u8 const *>(mapping) + sizeof(PcmHeader));
+    return std::make_unique<MappedPcm>(mapping, length, std::span{ samples, static_cast<usize>(header.samples) });
+}
+
+/**
+ * Creates the header of a cache file
+ * @param samples The amount of samples in the file
+ * @return The header
+ */
+PcmHeader make_header(u64 const samples) {
+    return PcmHeader{
+        .magic = PCM_MAGIC,
+        .version = PCM_VERSION,
+        .sample_rate = PCM_SAMPLE_RATE,
+        .channels = PCM_CHANNELS,
+        .format = PcmFormat::S16,
+        .samples = samples,
+    };
+}
+
+}// anonymous namespace
+
+PcmSpill::PcmSpill(utils::FileCache &files, std::filesystem::path path)
+    : m_files{ files },
+      m_path{ std::move(path) },
+      m_file{ m_path, std::ios::binary | std::ios::trunc },
+      m_samples{ 0 },
+      m_committed{ false } {
+    // The amount of samples is only known at the end, so the header is rewritten on commit
+    auto const header = make_header(0);
+    m_file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+}
+
+PcmSpill::~PcmSpill() {
+    if (not m_committed) {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+}
+
+void PcmSpill::write(std::span<s16 const> const samples) {
+    m_file.write(reinterpret_cast<char const *>(samples.data()), static_cast<std::streamsize>(samples.size_bytes()));
+    m_samples += samples.size();
+}
+
+bool PcmSpill::commit(std::string const &key) {
+    auto const header = make_header(m_samples);
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    m_file.close();
+    if (not m_file) {
+        spdlog::warn("Could not write PCM {} to cache", key);
+        return false;
+    }
+
+    m_committed = m_files.insert(key, m_path);
+    return m_committed;
+}
+
+PcmCache::PcmCache(std::filesystem::path directory, usize const capacity)
+    : m_files{ std::move(directory), PCM_EXTENSION, capacity } {
+    spdlog::info("PCM cache holds {} files ({} bytes)", m_files.count(), m_files.size());
+}
+
+std::string PcmCache::key(UploadDigest const &digest, DecodeOptions const &options) {
+    return std::format("{:016x}-{}-{}", digest.hash, digest.size, options.fast_resample ? "fast" : "swr");
+}
+
+std::optional<PcmStream> PcmCache::open(std::string const &key) {
+    auto const path = m_files.find(key);
+    if (not path) {
+        return std::nullopt;
+    }
+
+    auto mapped = map_pcm(*path);
+    if (not mapped) {
+        // The file was evicted concurrently or damaged outside of the cache
+        spdlog::warn("Dropping unusable cached PCM: {}", mapped.error());
+        m_files.discard(key);
+        return std::nullopt;
+    }
+    return PcmStream::open_decoded(std::move(*mapped));
+}
+
+std::unique_ptr<PcmSpill> PcmCache::spill() {
+    // The spill cannot be created with make_unique, as its constructor is private
+    std::unique_ptr<PcmSpill> spill{ new PcmSpill{ m_files, m_files.temporary("spill") } };
+    if (not spill->m_file) {
+        spdlog::warn("Could not create PCM spill file {}", spill->m_path.string());
+        return nullptr;
+    }
+    return spill;
+}
+
+utils::FileCacheStats PcmCache::stats() const {
+    return m_files.stats();
+}
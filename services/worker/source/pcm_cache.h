@@ -0,0 +1,125 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef PCM_CACHE_H
+#define PCM_CACHE_H
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "decode.h"
+#include "types.h"
+#include "upload.h"
+#include "utils/file_cache.h"
+
+class PcmCache;
+
+/**
+ * A PcmSpill writes the PCM of one request to a temporary cache file while it is transcribed.
+ * The file only becomes part of the cache once it is committed, otherwise it is deleted.
+ */
+class PcmSpill {
+public:
+    ~PcmSpill();
+
+    PcmSpill(PcmSpill const &) = delete;
+    PcmSpill &operator=(PcmSpill const &) = delete;
+
+    /**
+     * Appends samples to the file
+     * @param samples The 16 kHz mono samples
+     */
+    void write(std::span<s16 const> samples);
+
+    /**
+     * Completes the file and moves it into the cache
+     * @param key The key of the PCM, which is only known once the upload is received completely
+     * @return Whether the PCM was stored
+     */
+    bool commit(std::string const &key);
+
+private:
+    friend class PcmCache;
+
+    PcmSpill(utils::FileCache &files, std::filesystem::path path);
+
+    utils::FileCache &m_files;
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+    u64 m_samples;
+    bool m_committed;
+};
+
+/**
+ * The PcmCache stores the decoded 16 kHz mono PCM of uploads on disk, addressed by the content
+ * of the upload. Transcribing the same upload again, e.g. with another model or profile, maps the
+ * cached PCM into memory instead of decoding the media again. Once the cache exceeds its capacity,
+ * the least recently used files are deleted.
+ *
+ * The files consist of a 32 byte header followed by the raw samples in native byte order.
+ */
+class PcmCache {
+public:
+    /**
+     * Instantiates a new PCM cache, the files that are already in the directory are reused
+     * @param directory The directory of the cache, it is created if it does not exist
+     * @param capacity The size in bytes that the cached files may occupy
+     */
+    PcmCache(std::filesystem::path directory, usize capacity);
+
+    /**
+     * Computes the key of the PCM of an upload, which is safe to use as a file name
+     * @param digest The digest of the upload
+     * @param options The decode options, as the resampler affects the samples
+     * @return The key of the PCM
+     */
+    [[nodiscard]] static std::string key(UploadDigest const &digest, DecodeOptions const &options);
+
+    /**
+     * Maps cached PCM into memory
+     * @param key The key of the PCM
+     * @return A stream on the mapped samples, or nothing if the PCM is not cached
+     */
+    [[nodiscard]] std::optional<PcmStream> open(std::string const &key);
+
+    /**
+     * Starts writing the PCM of a request to the cache
+     * @return The spill, or nullptr if the temporary file cannot be created
+     */
+    [[nodiscard]] std::unique_ptr<PcmSpill> spill();
+
+    /**
+     * The counters of the cache since it was instantiated
+     * @return The counters
+     */
+    [[nodiscard]] utils::FileCacheStats stats() const;
+
+private:
+    utils::FileCache m_files;
+};
+
+#endif// PCM_CACHE_H
@@ -0,0 +1,315 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "persistence_sessions.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <set>
+#include <utility>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Broken streams are reopened after a delay that doubles with every failed attempt
+constexpr auto MIN_RECONNECT_DELAY = std::chrono::milliseconds{ 100 };
+constexpr auto MAX_RECONNECT_DELAY = std::chrono::milliseconds{ 5000 };
+
+// Without a spool, the chunks beyond this many per lane are dropped while persistence is unreachable
+constexpr usize MAX_QUEUED_CHUNKS = 65536;
+
+// Streams are closed after this many chunks, once no transcript or summary is open on them. Persistence saves
+// what it received of the open ones when a stream closes, hence streams are only rotated between them.
+constexpr usize ROTATION_CHUNKS = 4096;
+
+// Streams are closed when no chunk was queued for this long
+constexpr auto IDLE_TIMEOUT = std::chrono::seconds{ 2 };
+
+/**
+ * The ID that the chunks of a stream are grouped by in persistence
+ * @param kind The kind of the stream
+ * @param chunk The chunk
+ * @return The ID of the transcript or summary
+ */
+std::string const &chunk_id(PersistenceKind const kind, persistence::Chunk const &chunk) {
+    return kind == PersistenceKind::Transcript ? chunk.transcriptid() : chunk.summaryid();
+}
+
+/**
+ * The name of a kind for logging
+ * @param kind The kind
+ * @return The name
+ */
+char const *kind_name(PersistenceKind const kind) {
+    return kind == PersistenceKind::Transcript ? "transcript" : "summary";
+}
+
+}// anonymous namespace
+
+PersistenceSessions::PersistenceSessions(std::shared_ptr<persistence::Persistence::Stub> stub,
+                                         usize const streams,
+                                         std::unique_ptr<PersistenceSpool> spool)
+    : m_stub{ std::move(stub) },
+      m_spool{ std::move(spool) },
+      m_stopped{ false } {
+    for (usize i = 0; i < std::max<usize>(streams, 1); ++i) {
+        m_lanes.push_back(std::make_unique<Lane>());
+    }
+    for (auto &lane: m_lanes) {
+        lane->thread = std::thread{ [this, &lane = *lane] { run(lane); } };
+    }
+
+    if (not m_spool) {
+        return;
+    }
+
+    // The requests of transcripts and summaries that did not end before the restart are gone, so they never end
+    auto records = m_spool->recover();
+    std::set<std::pair<PersistenceKind, std::string>> finished;
+    for (auto const &record: records) {
+        if (record.chunk.finished()) {
+            finished.emplace(record.kind, chunk_id(record.kind, record.chunk));
+        }
+    }
+
+    usize recovered = 0;
+    for (auto &record: records) {
+        if (not finished.contains({ record.kind, chunk_id(record.kind, record.chunk) })) {
+            m_spool->acknowledge(record.segment);
+            continue;
+        }
+        enqueue(Message{ .kind = record.kind, .chunk = std::move(record.chunk), .segment = record.segment }, false);
+        ++recovered;
+    }
+
+    if (not records.empty()) {
+        spdlog::info("Recovered {} of {} spooled persistence chunks", recovered, records.size());
+    }
+}
+
+PersistenceSessions::~PersistenceSessions() {
+    m_stopped = true;
+    for (auto &lane: m_lanes) {
+        {
+            std::lock_guard lock{ lane->mutex };
+            lane->available.notify_all();
+        }
+        lane->thread.join();
+    }
+}
+
+void PersistenceSessions::write(PersistenceKind const kind, persistence::Chunk chunk) {
+    auto const segment = m_spool ? m_spool->append(kind, chunk) : 0;
+    enqueue(Message{ .kind = kind, .chunk = std::move(chunk), .segment = segment }, true);
+}
+
+void PersistenceSessions::finish(PersistenceKind const kind,
+                                 std::string const &transcript_id,
+                                 std::string const &summary_id,
+                                 std::string const &user_id) {
+    persistence::Chunk chunk;
+    chunk.set_transcriptid(transcript_id);
+    chunk.set_summaryid(summary_id);
+    chunk.set_userid(user_id);
+    chunk.set_finished(true);
+
+    // The end is never dropped, otherwise the chunks that were written would never be saved
+    auto const segment = m_spool ? m_spool->append(kind, chunk) : 0;
+    enqueue(Message{ .kind = kind, .chunk = std::move(chunk), .segment = segment }, false);
+}
+
+void PersistenceSessions::enqueue(Message message, bool const droppable) {
+    auto &selected = lane(message.kind, message.chunk);
+    {
+        std::lock_guard lock{ selected.mutex };
+
+        // Spooled chunks are kept on disk anyway, so they are not dropped
+        if (droppable and not m_spool and selected.queue.size() >= MAX_QUEUED_CHUNKS) {
+            spdlog::warn("Persistence is behind, dropping {} chunk of {}", kind_name(message.kind),
+                         chunk_id(message.kind, message.chunk));
+            return;
+        }
+        selected.queue.push_back(std::move(message));
+    }
+    selected.available.notify_one();
+}
+
+void PersistenceSessions::run(Lane &lane) {
+    std::array<Stream, 2> streams;
+    while (true) {
+        Message message;
+        {
+            std::unique_lock lock{ lane.mutex };
+            auto const available = lane.available.wait_for(lock, IDLE_TIMEOUT, [this, &lane] {
+                return not lane.queue.empty() or m_stopped;
+            });
+
+            if (not available) {
+                lock.unlock();
+                for (auto const kind: { PersistenceKind::Transcript, PersistenceKind::Summary }) {
+                    if (auto &stream = streams[static_cast<usize>(kind)]; stream.open.empty()) {
+                        rotate(lane, stream, kind);
+                    }
+                }
+                continue;
+            }
+
+            if (lane.queue.empty()) {
+                break;
+            }
+
+            message = std::move(lane.queue.front());
+            lane.queue.pop_front();
+        }
+
+        auto const kind = message.kind;
+        auto &stream = streams[static_cast<usize>(kind)];
+        deliver(lane, stream, kind, std::move(message));
+        if (stream.delivered >= ROTATION_CHUNKS and stream.open.empty()) {
+            rotate(lane, stream, kind);
+        }
+    }
+
+    for (auto const kind: { PersistenceKind::Transcript, PersistenceKind::Summary }) {
+        rotate(lane, streams[static_cast<usize>(kind)], kind);
+    }
+}
+
+void PersistenceSessions::deliver(Lane &lane, Stream &stream, PersistenceKind const kind, Message message) {
+    auto const id = chunk_id(kind, message.chunk);
+    auto const finished = message.chunk.finished();
+    if (finished) {
+        stream.open.erase(id);
+    } else {
+        stream.open.insert(id);
+    }
+    stream.written.push_back(std::move(message));
+    ++stream.delivered;
+
+    // Connecting writes all written chunks again, which already includes this chunk
+    auto const delivered = retry(lane, stream, kind, [this, &stream, kind] {
+        return stream.writer ? stream.writer->Write(stream.written.back().chunk) : connect(stream, kind);
+    });
+
+    if (not delivered) {
+        spdlog::error("Cannot persist {} {}, unable to establish connection!", kind_name(kind), id);
+        return;
+    }
+
+    // The transcript or summary is saved by persistence once its end arrives, it is not written again
+    if (finished) {
+        complete(stream, kind, id);
+    }
+}
+
+void PersistenceSessions::complete(Stream &stream, PersistenceKind const kind, std::string const &id) {
+    std::erase_if(stream.written, [this, kind, &id](Message const &message) {
+        if (chunk_id(kind, message.chunk) != id) {
+            return false;
+        }
+        if (m_spool) {
+            m_spool->acknowledge(message.segment);
+        }
+        return true;
+    });
+}
+
+void PersistenceSessions::rotate(Lane &lane, Stream &stream, PersistenceKind const kind) {
+    stream.delivered = 0;
+    if (stream.written.empty()) {
+        disconnect(stream, kind);
+        return;
+    }
+
+    // The chunks of open transcripts and summaries are kept, the next stream is opened once a chunk is queued
+    auto const closed = retry(lane, stream, kind, [this, &stream, kind] {
+        return (stream.writer or connect(stream, kind)) and disconnect(stream, kind);
+    });
+
+    if (not closed) {
+        // Spooled chunks are written again after the restart
+        spdlog::error("Cannot close persistence {} stream with {} open chunks, unable to establish connection!",
+                      kind_name(kind), stream.written.size());
+    }
+}
+
+bool PersistenceSessions::retry(Lane &lane,
+                                Stream &stream,
+                                PersistenceKind const kind,
+                                std::function<bool()> const &operation) {
+    auto delay = MIN_RECONNECT_DELAY;
+    while (not operation()) {
+        disconnect(stream, kind);
+        if (m_stopped) {
+            return false;
+        }
+
+        spdlog::warn("Persistence {} stream broke, reconnecting in {} ms", kind_name(kind), delay.count());
+        {
+            std::unique_lock lock{ lane.mutex };
+            lane.available.wait_for(lock, delay, [this] { return m_stopped.load(); });
+        }
+        delay = std::min(delay * 2, MAX_RECONNECT_DELAY);
+    }
+    return true;
+}
+
+bool PersistenceSessions::connect(Stream &stream, PersistenceKind const kind) {
+    stream.context = std::make_unique<grpc::ClientContext>();
+    stream.writer = kind == PersistenceKind::Transcript
+                            ? m_stub->persistTranscript(stream.context.get(), &stream.response)
+                            : m_stub->persistSummary(stream.context.get(), &stream.response);
+    if (not stream.writer) {
+        return false;
+    }
+
+    // Persistence saves transcripts and summaries by their ID, so writing them again is harmless
+    for (auto const &message: stream.written) {
+        if (not stream.writer->Write(message.chunk)) {
+            return false;
+        }
+    }
+
+    spdlog::debug("Opened persistence {} stream", kind_name(kind));
+    return true;
+}
+
+bool PersistenceSessions::disconnect(Stream &stream, PersistenceKind const kind) {
+    auto closed = true;
+    if (stream.writer) {
+        stream.writer->WritesDone();
+        if (auto const status = stream.writer->Finish(); not status.ok()) {
+            spdlog::warn("Persistence {} stream closed: {}", kind_name(kind), status.error_message());
+            closed = false;
+        }
+    }
+    stream.writer.reset();
+    stream.context.reset();
+    return closed;
+}
+
+PersistenceSessions::Lane &PersistenceSessions::lane(PersistenceKind const kind, persistence::Chunk const &chunk) {
+    return *m_lanes[std::hash<std::string>{}(chunk_id(kind, chunk)) % m_lanes.size()];
+}
@@ -0,0 +1,212 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef PERSISTENCE_SESSIONS_H
+#define PERSISTENCE_SESSIONS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <persistence.grpc.pb.h>
+
+#include "persistence_spool.h"
+#include "types.h"
+
+/**
+ * The PersistenceSessions keep a few long-lived streams to the persistence service open and
+ * multiplex the chunks of all requests onto them, so a request does not set up a stream of its own.
+ * All chunks of one transcript or summary are written to the same stream, followed by a finished
+ * chunk that tells persistence to save it. Once the finished chunk is written, the chunks of the
+ * transcript or summary are dropped. Broken streams are reopened in the background and the chunks
+ * of the transcripts and summaries that are still open are written again. Streams are closed when
+ * they are idle and after a while, but only between transcripts and summaries, as persistence saves
+ * the open ones when a stream closes. With a spool, chunks are also appended to disk until their
+ * transcript or summary is finished, so they are written again after a restart of the worker.
+ */
+class PersistenceSessions {
+public:
+    /**
+     * Starts the threads that write to the streams, the streams are opened once they are needed
+     * @param stub The persistence stub
+     * @param streams The amount of streams per kind
+     * @param spool The spool that keeps chunks until persistence received them, or nullptr
+     */
+    PersistenceSessions(std::shared_ptr<persistence::Persistence::Stub> stub,
+                        usize streams,
+                        std::unique_ptr<PersistenceSpool> spool = nullptr);
+
+    /**
+     * Writes the remaining chunks and closes the streams
+     */
+    ~PersistenceSessions();
+
+    PersistenceSessions(PersistenceSessions const &) = delete;
+    PersistenceSessions &operator=(PersistenceSessions const &) = delete;
+
+    /**
+     * Queues a chunk, it is written to persistence in the background
+     * @param kind What the chunk belongs to
+     * @param chunk The chunk
+     */
+    void write(PersistenceKind kind, persistence::Chunk chunk);
+
+    /**
+     * Queues the end of a transcript or summary, which is saved by persistence once the end is written
+     * @param kind What ends
+     * @param transcript_id The ID of the transcript, or the transcript that is summarized
+     * @param summary_id The ID of the summary, empty for transcripts
+     * @param user_id The ID of the user
+     */
+    void finish(PersistenceKind kind,
+                std::string const &transcript_id,
+                std::string const &summary_id,
+                std::string const &user_id);
+
+private:
+    /**
+     * A queued chunk
+     */
+    struct Message {
+        PersistenceKind kind;
+        persistence::Chunk chunk;
+
+        // The spool segment that holds the chunk, zero without a spool
+        u64 segment;
+    };
+
+    /**
+     * An open stream of one kind, along with the chunks that must be written again if it breaks
+     */
+    struct Stream {
+        std::unique_ptr<grpc::ClientContext> context;
+        google::protobuf::Empty response;
+        std::unique_ptr<grpc::ClientWriter<persistence::Chunk>> writer;
+
+        // The chunks of the transcripts or summaries whose end was not written yet
+        std::vector<Message> written;
+
+        // The transcripts or summaries whose end was not written yet
+        std::unordered_set<std::string> open;
+
+        // The chunks that were queued to the stream since it was last closed, without the ones written again
+        usize delivered = 0;
+    };
+
+    /**
+     * One stream per kind along with the thread that writes to them
+     */
+    struct Lane {
+        std::mutex mutex;
+        std::condition_variable available;
+        std::deque<Message> queue;
+        std::thread thread;
+    };
+
+    /**
+     * Queues a chunk for its lane
+     * @param message The chunk
+     * @param droppable Whether the chunk may be dropped if persistence is behind
+     */
+    void enqueue(Message message, bool droppable);
+
+    /**
+     * The loop of the thread of a lane
+     * @param lane The lane
+     */
+    void run(Lane &lane);
+
+    /**
+     * Writes a chunk to its stream, reopening the stream until the chunk is written or the sessions stop
+     * @param lane The lane of the stream
+     * @param stream The stream
+     * @param kind The kind of the stream
+     * @param message The chunk
+     */
+    void deliver(Lane &lane, Stream &stream, PersistenceKind kind, Message message);
+
+    /**
+     * Drops the chunks of a transcript or summary once its end is written
+     * @param stream The stream
+     * @param kind The kind of the stream
+     * @param id The ID of the transcript or summary
+     */
+    void complete(Stream &stream, PersistenceKind kind, std::string const &id);
+
+    /**
+     * Closes a stream, persistence saves the transcripts and summaries that are open on it so far.
+     * Their chunks are written again on the next stream, which continues them.
+     * @param lane The lane of the stream
+     * @param stream The stream
+     * @param kind The kind of the stream
+     */
+    void rotate(Lane &lane, Stream &stream, PersistenceKind kind);
+
+    /**
+     * Repeats an operation on a stream, reopening the stream in between, until it succeeds or the sessions stop
+     * @param lane The lane of the stream
+     * @param stream The stream
+     * @param kind The kind of the stream
+     * @param operation The operation, returns whether it succeeded
+     * @return Whether the operation succeeded
+     */
+    bool retry(Lane &lane, Stream &stream, PersistenceKind kind, std::function<bool()> const &operation);
+
+    /**
+     * Opens a stream and writes the chunks of the open transcripts and summaries again
+     * @param stream The stream
+     * @param kind The kind of the stream
+     * @return Whether the stream is usable
+     */
+    bool connect(Stream &stream, PersistenceKind kind);
+
+    /**
+     * Closes a stream
+     * @param stream The stream
+     * @param kind The kind of the stream
+     * @return Whether persistence received all written chunks
+     */
+    static bool disconnect(Stream &stream, PersistenceKind kind);
+
+    /**
+     * Selects the lane of a chunk, the chunks of one transcript or summary always use the same lane
+     * @param kind The kind of the chunk
+     * @param chunk The chunk
+     * @return The lane
+     */
+    Lane &lane(PersistenceKind kind, persistence::Chunk const &chunk);
+
+    std::shared_ptr<persistence::Persistence::Stub> m_stub;
+    std::unique_ptr<PersistenceSpool> m_spool;
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    std::atomic<bool> m_stopped;
+};
+
+#endif// PERSISTENCE_SESSIONS_H
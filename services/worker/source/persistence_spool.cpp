@@ -0,0 +1,276 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "persistence_spool.h"
+
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include "utils/hash.h"
+
+namespace {
+
+// A new segment file is started once the current one exceeds this size
+constexpr usize SEGMENT_SIZE = 16 * 1024 * 1024;
+
+// Segment files are named after their hexadecimal ID, which grows with every segment
+constexpr auto SEGMENT_EXTENSION = ".spool";
+
+/**
+ * The header that precedes the serialized chunk of a record. The checksum detects records that
+ * were torn by a crash while they were written.
+ */
+struct RecordHeader {
+    u32 size;
+    u32 kind;
+    u64 checksum;
+};
+
+static_assert(sizeof(RecordHeader) == 16);
+
+/**
+ * Computes the checksum of a serialized chunk
+ * @param payload The serialized chunk
+ * @return The checksum
+ */
+u64 checksum(std::string_view const payload) {
+    utils::XXHash64 hash;
+    hash.update(payload.data(), payload.size());
+    return hash.digest();
+}
+
+/**
+ * Syncs the entries of a directory, so newly created files survive a crash
+ * @param directory The directory
+ */
+void sync_directory(std::filesystem::path const &directory) {
+    if (auto const fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC); fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+}// anonymous namespace
+
+PersistenceSpool::PersistenceSpool(std::filesystem::path directory, std::chrono::milliseconds const sync_interval)
+    : m_directory{ std::move(directory) },
+      m_sync_interval{ sync_interval },
+      m_active{ 1 },
+      m_active_size{ 0 },
+      m_stopped{ false },
+      m_fd{ -1 },
+      m_open{ 0 } {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        spdlog::error("Could not create persistence spool directory {}: {}", m_directory.string(), error.message());
+    }
+
+    // Recover the segments of previous runs in the order they were written
+    std::map<u64, std::filesystem::path> files;
+    for (auto const &entry: std::filesystem::directory_iterator{ m_directory, error }) {
+        auto const stem = entry.path().stem().string();
+        u64 segment = 0;
+        if (entry.path().extension() == SEGMENT_EXTENSION and
+            std::from_chars(stem.data(), stem.data() + stem.size(), segment, 16).ec == std::errc{}) {
+            files.emplace(segment, entry.path());
+        }
+    }
+
+    for (auto const &[segment, file]: files) {
+        std::ifstream stream{ file, std::ios::binary };
+        std::string const bytes{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+
+        // A crash may leave a torn record at the end, everything before it is intact
+        usize records = 0;
+        usize offset = 0;
+        while (offset + sizeof(RecordHeader) <= bytes.size()) {
+            RecordHeader header;
+            std::memcpy(&header, bytes.data() + offset, sizeof(header));
+            offset += sizeof(header);
+
+            std::string_view const payload{ bytes.data() + offset, std::min<usize>(header.size, bytes.size() - offset) };
+            persistence::Chunk chunk;
+            if (payload.size() != header.size or checksum(payload) != header.checksum or
+                not chunk.ParseFromArray(payload.data(), static_cast<int>(payload.size()))) {
+                spdlog::warn("Dropping torn record at the end of persistence spool segment {}", file.string());
+                break;
+            }
+            offset += payload.size();
+
+            m_recovered.push_back(
+                    Record{ .kind = static_cast<PersistenceKind>(header.kind), .chunk = std::move(chunk), .segment = segment });
+            ++records;
+        }
+
+        if (records == 0) {
+            std::filesystem::remove(file, error);
+        } else {
+            m_segments[segment] = Segment{ .outstanding = records };
+        }
+        m_active = segment + 1;
+    }
+
+    m_thread = std::thread{ [this] { run(); } };
+}
+
+PersistenceSpool::~PersistenceSpool() {
+    {
+        std::lock_guard lock{ m_mutex };
+        m_stopped = true;
+    }
+    m_wakeup.notify_one();
+    m_thread.join();
+}
+
+std::vector<PersistenceSpool::Record> PersistenceSpool::recover() {
+    std::lock_guard lock{ m_mutex };
+    return std::exchange(m_recovered, {});
+}
+
+u64 PersistenceSpool::append(PersistenceKind const kind, persistence::Chunk const &chunk) {
+    auto const payload = chunk.SerializeAsString();
+    RecordHeader const header{ .size = static_cast<u32>(payload.size()),
+                               .kind = static_cast<u32>(kind),
+                               .checksum = checksum(payload) };
+
+    std::lock_guard lock{ m_mutex };
+    if (m_active_size >= SEGMENT_SIZE) {
+        ++m_active;
+        m_active_size = 0;
+    }
+
+    ++m_segments[m_active].outstanding;
+    if (m_blocks.empty() or m_blocks.back().segment != m_active) {
+        m_blocks.push_back(Block{ .segment = m_active, .bytes = {} });
+    }
+
+    auto &bytes = m_blocks.back().bytes;
+    bytes.append(reinterpret_cast<char const *>(&header), sizeof(header));
+    bytes.append(payload);
+    m_active_size += sizeof(header) + payload.size();
+    return m_active;
+}
+
+void PersistenceSpool::acknowledge(u64 const segment) {
+    std::lock_guard lock{ m_mutex };
+    if (auto const entry = m_segments.find(segment); entry != m_segments.end() and entry->second.outstanding > 0) {
+        --entry->second.outstanding;
+    }
+}
+
+void PersistenceSpool::run() {
+    std::unique_lock lock{ m_mutex };
+    while (true) {
+        m_wakeup.wait_for(lock, m_sync_interval, [this] { return m_stopped; });
+        auto const stopping = m_stopped;
+        auto const blocks = std::exchange(m_blocks, {});
+
+        // Appending continues while the blocks are written and synced
+        lock.unlock();
+        write(blocks);
+        lock.lock();
+
+        // Segments that are complete, written and acknowledged are not needed anymore
+        for (auto segment = m_segments.begin(); segment != m_segments.end();) {
+            auto const complete = segment->first < m_active and
+                                  (m_blocks.empty() or m_blocks.front().segment > segment->first);
+            if (not complete or segment->second.outstanding > 0) {
+                ++segment;
+                continue;
+            }
+
+            if (m_open == segment->first) {
+                close(m_fd);
+                m_fd = -1;
+                m_open = 0;
+            }
+
+            std::error_code error;
+            std::filesystem::remove(path(segment->first), error);
+            segment = m_segments.erase(segment);
+        }
+
+        if (stopping) {
+            break;
+        }
+    }
+
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+void PersistenceSpool::write(std::deque<Block> const &blocks) {
+    for (auto const &block: blocks) {
+        if (block.segment != m_open) {
+            if (m_fd >= 0) {
+                fdatasync(m_fd);
+                close(m_fd);
+            }
+
+            m_fd = ::open(path(block.segment).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            m_open = block.segment;
+            if (m_fd < 0) {
+                spdlog::error("Could not open persistence spool segment {}: {}", path(block.segment).string(),
+                              std::strerror(errno));
+                continue;
+            }
+            sync_directory(m_directory);
+        }
+
+        if (m_fd < 0) {
+            continue;
+        }
+
+        for (usize written = 0; written < block.bytes.size();) {
+            auto const result = ::write(m_fd, block.bytes.data() + written, block.bytes.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                spdlog::error("Could not write persistence spool segment {}: {}", path(block.segment).string(),
+                              std::strerror(errno));
+                break;
+            }
+            written += static_cast<usize>(result);
+        }
+    }
+
+    // One sync covers all chunks that were appended since the last one
+    if (m_fd >= 0 and not blocks.empty()) {
+        fdatasync(m_fd);
+    }
+}
+
+std::filesystem::path PersistenceSpool::path(u64 const segment) const {
+    return m_directory / std::format("{:016x}{}", segment, SEGMENT_EXTENSION);
+}
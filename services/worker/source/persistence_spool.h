@@ -0,0 +1,156 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef PERSISTENCE_SPOOL_H
+#define PERSISTENCE_SPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <persistence.grpc.pb.h>
+
+#include "types.h"
+
+/**
+ * What is persisted, every kind is written to its own persistence stream
+ */
+enum class PersistenceKind {
+    Transcript,
+    Summary,
+};
+
+/**
+ * The PersistenceSpool is an append-only log of the chunks that are on their way to persistence,
+ * so they survive outages of persistence as well as restarts of the worker. The log is split into
+ * segment files, which are deleted once all of their chunks were acknowledged by persistence.
+ * Appending never waits for the disk, the chunks are synced in batches by a background thread.
+ */
+class PersistenceSpool {
+public:
+    /**
+     * A chunk that was appended to the spool
+     */
+    struct Record {
+        PersistenceKind kind;
+        persistence::Chunk chunk;
+
+        // The segment that holds the record, which is passed to acknowledge
+        u64 segment;
+    };
+
+    /**
+     * Opens the spool, the chunks of a previous run that were not acknowledged are recovered
+     * @param directory The directory of the segment files, it is created if it does not exist
+     * @param sync_interval How long appended chunks may wait until they are synced to disk
+     */
+    PersistenceSpool(std::filesystem::path directory, std::chrono::milliseconds sync_interval);
+
+    /**
+     * Syncs the remaining chunks to disk
+     */
+    ~PersistenceSpool();
+
+    PersistenceSpool(PersistenceSpool const &) = delete;
+    PersistenceSpool &operator=(PersistenceSpool const &) = delete;
+
+    /**
+     * Takes the chunks of a previous run that were not acknowledged, in the order they were appended
+     * @return The recovered chunks
+     */
+    [[nodiscard]] std::vector<Record> recover();
+
+    /**
+     * Appends a chunk to the spool
+     * @param kind What the chunk belongs to
+     * @param chunk The chunk
+     * @return The segment that holds the chunk
+     */
+    u64 append(PersistenceKind kind, persistence::Chunk const &chunk);
+
+    /**
+     * Acknowledges that persistence received a chunk, which is then not recovered anymore
+     * @param segment The segment that holds the chunk
+     */
+    void acknowledge(u64 segment);
+
+private:
+    /**
+     * A segment file and the amount of its chunks that were not acknowledged yet
+     */
+    struct Segment {
+        usize outstanding;
+    };
+
+    /**
+     * Appended bytes that were not written to their segment file yet
+     */
+    struct Block {
+        u64 segment;
+        std::string bytes;
+    };
+
+    /**
+     * The loop of the sync thread
+     */
+    void run();
+
+    /**
+     * Writes blocks to their segment files and syncs them
+     * @param blocks The blocks
+     */
+    void write(std::deque<Block> const &blocks);
+
+    /**
+     * The path of a segment file
+     * @param segment The segment
+     * @return The path of the file
+     */
+    [[nodiscard]] std::filesystem::path path(u64 segment) const;
+
+    std::filesystem::path m_directory;
+    std::chrono::milliseconds m_sync_interval;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::map<u64, Segment> m_segments;
+    std::deque<Block> m_blocks;
+    std::vector<Record> m_recovered;
+    u64 m_active;
+    usize m_active_size;
+    bool m_stopped;
+
+    // Only accessed by the sync thread
+    int m_fd;
+    u64 m_open;
+
+    std::thread m_thread;
+};
+
+#endif// PERSISTENCE_SPOOL_H
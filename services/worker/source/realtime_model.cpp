@@ -0,0 +1,65 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "realtime_model.h"
+
+#include <format>
+
+namespace {
+
+// Transcriptions of very short audio are dominated by fixed costs, they do not tell the realtime factor
+constexpr f64 MIN_AUDIO_SECONDS = 10.0;
+
+// The factor of a configuration is only trusted after this many transcriptions
+constexpr usize MIN_OBSERVATIONS = 3;
+
+// The weight of the latest transcription in the moving average
+constexpr f64 AVERAGE_WEIGHT = 0.2;
+
+}// anonymous namespace
+
+std::string RealtimeModel::key(std::string const &model, transcriber::Profile const profile, usize const threads) {
+    return std::format("{}-{}-{}", model, transcriber::Profile_Name(profile), threads);
+}
+
+std::optional<f64> RealtimeModel::factor(std::string const &key) const {
+    std::lock_guard lock{ m_mutex };
+    auto const estimate = m_estimates.find(key);
+    if (estimate == m_estimates.end() or estimate->second.observations < MIN_OBSERVATIONS) {
+        return std::nullopt;
+    }
+    return estimate->second.factor;
+}
+
+void RealtimeModel::observe(std::string const &key, f64 const audio_seconds, f64 const compute_seconds) {
+    if (audio_seconds < MIN_AUDIO_SECONDS) {
+        return;
+    }
+
+    auto const factor = compute_seconds / audio_seconds;
+    std::lock_guard lock{ m_mutex };
+    auto &estimate = m_estimates[key];
+    estimate.factor =
+            estimate.observations == 0 ? factor : (1.0 - AVERAGE_WEIGHT) * estimate.factor + AVERAGE_WEIGHT * factor;
+    ++estimate.observations;
+}
@@ -0,0 +1,85 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef REALTIME_MODEL_H
+#define REALTIME_MODEL_H
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <transcriber.grpc.pb.h>
+
+#include "types.h"
+
+/**
+ * The RealtimeModel learns how long whisper takes per second of audio, i.e. the realtime factor, for every
+ * combination of model, profile and thread count. The factor is a moving average over the finished
+ * transcriptions, so it follows changes of the load and the hardware.
+ */
+class RealtimeModel {
+public:
+    RealtimeModel() = default;
+
+    RealtimeModel(RealtimeModel const &) = delete;
+    RealtimeModel &operator=(RealtimeModel const &) = delete;
+
+    /**
+     * Builds the key under which the factor of a configuration is learned
+     * @param model The name of the model
+     * @param profile The profile of the transcription
+     * @param threads The amount of threads of one whisper state
+     * @return The key
+     */
+    [[nodiscard]] static std::string key(std::string const &model, transcriber::Profile profile, usize threads);
+
+    /**
+     * The learned realtime factor of a configuration
+     * @param key The key of the configuration
+     * @return The realtime factor, or nothing if too few transcriptions of the configuration finished yet
+     */
+    [[nodiscard]] std::optional<f64> factor(std::string const &key) const;
+
+    /**
+     * Learns from a finished transcription
+     * @param key The key of the configuration
+     * @param audio_seconds The duration of the audio
+     * @param compute_seconds The time that whisper spent on the audio
+     */
+    void observe(std::string const &key, f64 audio_seconds, f64 compute_seconds);
+
+private:
+    /**
+     * The learned factor of one configuration
+     */
+    struct Estimate {
+        f64 factor;
+        usize observations;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Estimate> m_estimates;
+};
+
+#endif// REALTIME_MODEL_H
@@ -0,0 +1,430 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#define RESAMPLE_X86 1
+#endif
+
+namespace {
+
+// The output sample rate, which is what whisper expects
+constexpr int OUTPUT_RATE = 16000;
+
+// Input samples that contribute to one output sample, must be a multiple of 8 for the AVX2 kernels
+constexpr int FILTER_TAPS = 128;
+
+// Cutoff of the lowpass filter in Hz, below the 8 kHz Nyquist frequency of the output
+constexpr f64 FILTER_CUTOFF = 7200.0;
+
+// Shape of the Kaiser window, which yields roughly 80 dB of stopband attenuation
+constexpr f64 KAISER_BETA = 8.0;
+
+// Stereo is downmixed with the same coefficients as the default matrix of swresample
+constexpr f32 STEREO_GAIN = std::numbers::sqrt2_v<f32> / 2.0f;
+
+// Scale of signed 16 bit samples
+constexpr f32 S16_SCALE = 1.0f / 32768.0f;
+
+/**
+ * Computes the zeroth order modified Bessel function of the first kind
+ * @param x The argument
+ * @return I0(x)
+ */
+f64 bessel_i0(f64 const x) {
+    f64 sum = 1.0;
+    f64 term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Designs the polyphase windowed-sinc filter, every phase is normalized to unity gain
+ * @param interpolation The interpolation factor, which is the amount of phases
+ * @param input_rate The input sample rate
+ * @return The coefficients of all phases, FILTER_TAPS per phase
+ */
+std::vector<f32> design_filter(int const interpolation, int const input_rate) {
+    auto const cutoff = FILTER_CUTOFF / input_rate;
+    auto const half = FILTER_TAPS / 2.0;
+
+    std::vector<f32> coefficients(static_cast<usize>(interpolation) * FILTER_TAPS);
+    for (int phase = 0; phase < interpolation; ++phase) {
+        auto *taps = coefficients.data() + static_cast<usize>(phase) * FILTER_TAPS;
+        auto const fraction = static_cast<f64>(phase) / interpolation;
+
+        f64 sum = 0.0;
+        std::vector<f64> values(FILTER_TAPS);
+        for (int k = 0; k < FILTER_TAPS; ++k) {
+            // Distance of the input sample to the output sample, in input samples
+            auto const u = fraction + (half - 1.0) - k;
+            auto const x = 2.0 * cutoff * u;
+            auto const sinc = x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+            auto const ratio = std::clamp(u / half, -1.0, 1.0);
+            auto const window = bessel_i0(KAISER_BETA * std::sqrt(1.0 - ratio * ratio)) / bessel_i0(KAISER_BETA);
+            values[k] = sinc * window;
+            sum += values[k];
+        }
+
+        for (int k = 0; k < FILTER_TAPS; ++k) {
+            taps[k] = static_cast<f32>(values[k] / sum);
+        }
+    }
+
+    return coefficients;
+}
+
+f32 dot_scalar(f32 const *a, f32 const *b, usize const n) {
+    f32 sum = 0.0f;
+    for (usize i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void downmix_s16_stereo_scalar(s16 const *in, usize const frames, f32 *out) {
+    for (usize i = 0; i < frames; ++i) {
+        out[i] = static_cast<f32>(in[2 * i] + in[2 * i + 1]) * (S16_SCALE * STEREO_GAIN);
+    }
+}
+
+void downmix_f32_stereo_scalar(f32 const *in, usize const frames, f32 *out) {
+    for (usize i = 0; i < frames; ++i) {
+        out[i] = (in[2 * i] + in[2 * i + 1]) * STEREO_GAIN;
+    }
+}
+
+void downmix_f32p_stereo_scalar(f32 const *left, f32 const *right, usize const frames, f32 *out) {
+    for (usize i = 0; i < frames; ++i) {
+        out[i] = (left[i] + right[i]) * STEREO_GAIN;
+    }
+}
+
+void convert_s16_to_f32_scalar(s16 const *in, usize const count, f32 *out) {
+    for (usize i = 0; i < count; ++i) {
+        out[i] = static_cast<f32>(in[i]) * S16_SCALE;
+    }
+}
+
+void convert_f32_to_s16_scalar(f32 const *in, usize const count, s16 *out) {
+    for (usize i = 0; i < count; ++i) {
+        auto const sample = std::nearbyint(in[i] * 32768.0f);
+        out[i] = static_cast<s16>(std::clamp(sample, -32768.0f, 32767.0f));
+    }
+}
+
+#ifdef RESAMPLE_X86
+
+__attribute__((target("avx2,fma"))) f32 dot_avx2(f32 const *a, f32 const *b, usize const n) {
+    auto acc0 = _mm256_setzero_ps();
+    auto acc1 = _mm256_setzero_ps();
+    usize i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+
+    // Horizontal sum of the accumulators
+    auto const acc = _mm256_add_ps(acc0, acc1);
+    auto sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum) + dot_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) void downmix_s16_stereo_avx2(s16 const *in, usize const frames, f32 *out) {
+    auto const ones = _mm256_set1_epi16(1);
+    auto const scale = _mm256_set1_ps(S16_SCALE * STEREO_GAIN);
+    usize i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        // Adds the left and right sample of every frame into one 32 bit integer
+        auto const samples = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(in + 2 * i));
+        auto const sums = _mm256_madd_epi16(samples, ones);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(sums), scale));
+    }
+    downmix_s16_stereo_scalar(in + 2 * i, frames - i, out + i);
+}
+
+__attribute__((target("avx2,fma"))) void downmix_f32_stereo_avx2(f32 const *in, usize const frames, f32 *out) {
+    auto const gain = _mm256_set1_ps(STEREO_GAIN);
+    usize i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        // The horizontal add interleaves the 128 bit lanes, which the permutation restores
+        auto const sums = _mm256_hadd_ps(_mm256_loadu_ps(in + 2 * i), _mm256_loadu_ps(in + 2 * i + 8));
+        auto const ordered = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sums), 0b11011000));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(ordered, gain));
+    }
+    downmix_f32_stereo_scalar(in + 2 * i, frames - i, out + i);
+}
+
+__attribute__((target("avx2,fma"))) void downmix_f32p_stereo_avx2(f32 const *left,
+                                                                  f32 const *right,
+                                                                  usize const frames,
+                                                                  f32 *out) {
+    auto const gain = _mm256_set1_ps(STEREO_GAIN);
+    usize i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        auto const sums = _mm256_add_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(sums, gain));
+    }
+    downmix_f32p_stereo_scalar(left + i, right + i, frames - i, out + i);
+}
+
+__attribute__((target("avx2,fma"))) void convert_s16_to_f32_avx2(s16 const *in, usize const count, f32 *out) {
+    auto const scale = _mm256_set1_ps(S16_SCALE);
+    usize i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto const samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+    convert_s16_to_f32_scalar(in + i, count - i, out + i);
+}
+
+__attribute__((target("avx2,fma"))) void convert_f32_to_s16_avx2(f32 const *in, usize const count, s16 *out) {
+    auto const scale = _mm256_set1_ps(32768.0f);
+    auto const min = _mm256_set1_ps(-32768.0f);
+    auto const max = _mm256_set1_ps(32767.0f);
+    auto const quantize = [&](f32 const *samples) __attribute__((target("avx2,fma"))) {
+        auto const scaled = _mm256_mul_ps(_mm256_loadu_ps(samples), scale);
+        return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(scaled, min), max));
+    };
+
+    usize i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto const low = quantize(in + i);
+        auto const high = quantize(in + i + 8);
+
+        // Packing interleaves the 128 bit lanes, which the permutation restores
+        auto const packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0b11011000);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+    }
+    convert_f32_to_s16_scalar(in + i, count - i, out + i);
+}
+
+#endif
+
+/**
+ * The kernels are selected once at startup, depending on the capabilities of the CPU
+ */
+struct Kernels {
+    f32 (*dot)(f32 const *, f32 const *, usize) = dot_scalar;
+    void (*downmix_s16_stereo)(s16 const *, usize, f32 *) = downmix_s16_stereo_scalar;
+    void (*downmix_f32_stereo)(f32 const *, usize, f32 *) = downmix_f32_stereo_scalar;
+    void (*downmix_f32p_stereo)(f32 const *, f32 const *, usize, f32 *) = downmix_f32p_stereo_scalar;
+    void (*convert_s16_to_f32)(s16 const *, usize, f32 *) = convert_s16_to_f32_scalar;
+    void (*convert_f32_to_s16)(f32 const *, usize, s16 *) = convert_f32_to_s16_scalar;
+
+    explicit Kernels([[maybe_unused]] bool const vectorized) {
+#ifdef RESAMPLE_X86
+        if (vectorized and __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) {
+            dot = dot_avx2;
+            downmix_s16_stereo = downmix_s16_stereo_avx2;
+            downmix_f32_stereo = downmix_f32_stereo_avx2;
+            downmix_f32p_stereo = downmix_f32p_stereo_avx2;
+            convert_s16_to_f32 = convert_s16_to_f32_avx2;
+            convert_f32_to_s16 = convert_f32_to_s16_avx2;
+        }
+#endif
+    }
+};
+
+Kernels const KERNELS{ true };
+
+// The portable kernels, the vectorized kernels are checked against them
+Kernels const SCALAR_KERNELS{ false };
+
+/**
+ * The kernels of a resampler
+ * @param vectorized Whether the vectorized kernels are used if the CPU supports them
+ * @return The kernels
+ */
+Kernels const &select_kernels(bool const vectorized) {
+    return vectorized ? KERNELS : SCALAR_KERNELS;
+}
+
+/**
+ * Downmixes the input planes to mono float samples
+ * @param kernels The kernels that downmix and convert the samples
+ * @param layout The sample layout of the input
+ * @param channels The amount of channels, either one or two
+ * @param data The input planes
+ * @param frames The amount of samples per channel
+ * @param out The output, which must hold frames samples
+ */
+void downmix(Kernels const &kernels,
+             SampleLayout const layout,
+             int const channels,
+             u8 const *const *data,
+             usize const frames,
+             f32 *out) {
+    auto const *s16_samples = reinterpret_cast<s16 const *>(data[0]);
+    auto const *f32_samples = reinterpret_cast<f32 const *>(data[0]);
+
+    if (channels == 1) {
+        switch (layout) {
+            case SampleLayout::S16:
+            case SampleLayout::S16P:
+                kernels.convert_s16_to_f32(s16_samples, frames, out);
+                break;
+            case SampleLayout::F32:
+            case SampleLayout::F32P:
+                std::copy_n(f32_samples, frames, out);
+                break;
+        }
+        return;
+    }
+
+    switch (layout) {
+        case SampleLayout::S16:
+            kernels.downmix_s16_stereo(s16_samples, frames, out);
+            break;
+        case SampleLayout::S16P: {
+            auto const *right = reinterpret_cast<s16 const *>(data[1]);
+            for (usize i = 0; i < frames; ++i) {
+                out[i] = static_cast<f32>(s16_samples[i] + right[i]) * (S16_SCALE * STEREO_GAIN);
+            }
+            break;
+        }
+        case SampleLayout::F32:
+            kernels.downmix_f32_stereo(f32_samples, frames, out);
+            break;
+        case SampleLayout::F32P:
+            kernels.downmix_f32p_stereo(f32_samples, reinterpret_cast<f32 const *>(data[1]), frames, out);
+            break;
+    }
+}
+
+}// anonymous namespace
+
+std::unique_ptr<FastResampler> FastResampler::create(SampleLayout const layout,
+                                                     int const sample_rate,
+                                                     int const channels,
+                                                     bool const vectorized) {
+    if (channels < 1 or channels > 2) {
+        return nullptr;
+    }
+
+    if (sample_rate != 48000 and sample_rate != 44100 and sample_rate != OUTPUT_RATE) {
+        return nullptr;
+    }
+
+    // Reduce the sample rate ratio, e.g. 44.1 kHz -> 16 kHz interpolates by 160 and decimates by 441
+    auto const divisor = std::gcd(sample_rate, OUTPUT_RATE);
+    return std::unique_ptr<FastResampler>{
+        new FastResampler{ layout, channels, OUTPUT_RATE / divisor, sample_rate / divisor, vectorized }
+    };
+}
+
+FastResampler::FastResampler(SampleLayout const layout,
+                             int const channels,
+                             int const interpolation,
+                             int const decimation,
+                             bool const vectorized)
+    : m_layout{ layout },
+      m_channels{ channels },
+      m_interpolation{ interpolation },
+      m_decimation{ decimation },
+      m_vectorized{ vectorized },
+      m_index{ 0 },
+      m_phase{ 0 },
+      m_total_in{ 0 },
+      m_total_out{ 0 } {
+    if (m_interpolation != m_decimation) {
+        m_coefficients = design_filter(m_interpolation, OUTPUT_RATE * m_decimation / m_interpolation);
+
+        // The filter is centered on the output sample, so it starts half a filter before the first input sample
+        m_input.assign(FILTER_TAPS / 2 - 1, 0.0f);
+    }
+}
+
+void FastResampler::process(u8 const *const *data, usize const frames, std::vector<f32> &out) {
+    // Without a sample rate conversion, the downmix is the output
+    if (m_coefficients.empty()) {
+        auto const offset = out.size();
+        out.resize(offset + frames);
+        downmix(select_kernels(m_vectorized), m_layout, m_channels, data, frames, out.data() + offset);
+        return;
+    }
+
+    auto const offset = m_input.size();
+    m_input.resize(offset + frames);
+    downmix(select_kernels(m_vectorized), m_layout, m_channels, data, frames, m_input.data() + offset);
+    m_total_in += frames;
+    resample(out);
+}
+
+void FastResampler::flush(std::vector<f32> &out) {
+    if (m_coefficients.empty()) {
+        return;
+    }
+
+    // Pad the input, so the filter covers the last input samples completely
+    m_input.resize(m_input.size() + FILTER_TAPS / 2, 0.0f);
+    resample(out);
+}
+
+void FastResampler::resample(std::vector<f32> &out) {
+    // Never emit more samples than the input corresponds to at the output sample rate
+    auto const limit = (m_total_in * m_interpolation + m_decimation - 1) / m_decimation;
+    auto const available = m_input.size() >= FILTER_TAPS ? m_input.size() - FILTER_TAPS + 1 : 0;
+    out.reserve(out.size() + available * m_interpolation / m_decimation + 1);
+
+    auto const &kernels = select_kernels(m_vectorized);
+
+    while (m_index < available and m_total_out < limit) {
+        auto const *taps = m_coefficients.data() + static_cast<usize>(m_phase) * FILTER_TAPS;
+        out.push_back(kernels.dot(taps, m_input.data() + m_index, FILTER_TAPS));
+        ++m_total_out;
+
+        // Advance the position of the next output sample in the input
+        m_phase += m_decimation;
+        m_index += static_cast<usize>(m_phase / m_interpolation);
+        m_phase %= m_interpolation;
+    }
+
+    // Drop the input that no future output sample depends on
+    auto const consumed = std::min(m_index, m_input.size());
+    m_input.erase(m_input.begin(), m_input.begin() + static_cast<ssize>(consumed));
+    m_index -= consumed;
+}
+
+void convert_s16_to_f32(s16 const *in, usize const count, f32 *out) {
+    KERNELS.convert_s16_to_f32(in, count, out);
+}
+
+void convert_f32_to_s16(f32 const *in, usize const count, s16 *out) {
+    KERNELS.convert_f32_to_s16(in, count, out);
+}
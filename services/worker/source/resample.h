@@ -0,0 +1,121 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+#include <memory>
+#include <vector>
+
+#include "types.h"
+
+/**
+ * The sample layouts that are supported by the FastResampler
+ */
+enum class SampleLayout {
+    S16,// Interleaved signed 16 bit samples
+    S16P,// Planar signed 16 bit samples
+    F32,// Interleaved float samples
+    F32P,// Planar float samples
+};
+
+/**
+ * The FastResampler is a fast path for the most common input formats, i.e. mono or stereo
+ * s16/flt at 48 kHz, 44.1 kHz or 16 kHz. It downmixes to mono and resamples to 16 kHz with
+ * a polyphase windowed-sinc filter. The hot loops use AVX2 when the CPU supports it and a
+ * portable scalar implementation otherwise. Other formats are left to swresample.
+ */
+class FastResampler {
+public:
+    /**
+     * Creates a fast resampler for the given input format
+     * @param layout The sample layout of the input
+     * @param sample_rate The sample rate of the input
+     * @param channels The amount of channels of the input
+     * @param vectorized Whether the AVX2 kernels are used if the CPU supports them, the scalar kernels otherwise
+     * @return The resampler or nullptr if the format is not supported by the fast path
+     */
+    [[nodiscard]] static std::unique_ptr<FastResampler> create(SampleLayout layout,
+                                                               int sample_rate,
+                                                               int channels,
+                                                               bool vectorized = true);
+
+    /**
+     * Downmixes and resamples the given input and appends the output to out
+     * @param data The input planes, only the first plane is used for interleaved layouts
+     * @param frames The amount of samples per channel
+     * @param out The output samples at 16 kHz mono
+     */
+    void process(u8 const *const *data, usize frames, std::vector<f32> &out);
+
+    /**
+     * Appends the samples that are still held back by the filter to out
+     * @param out The output samples at 16 kHz mono
+     */
+    void flush(std::vector<f32> &out);
+
+private:
+    FastResampler(SampleLayout layout, int channels, int interpolation, int decimation, bool vectorized);
+
+    /**
+     * Computes all output samples for which the input is complete
+     * @param out The output samples
+     */
+    void resample(std::vector<f32> &out);
+
+    SampleLayout m_layout;
+    int m_channels;
+    int m_interpolation;
+    int m_decimation;
+    bool m_vectorized;
+
+    // Filter coefficients, one contiguous set of taps per phase
+    std::vector<f32> m_coefficients;
+
+    // Downmixed input that still contributes to future output samples
+    std::vector<f32> m_input;
+    usize m_index;
+    int m_phase;
+
+    // Counters to emit exactly as many samples as the sample rate ratio demands
+    u64 m_total_in;
+    u64 m_total_out;
+};
+
+/**
+ * Converts signed 16 bit samples to float samples in [-1, 1)
+ * @param in The input samples
+ * @param count The amount of samples
+ * @param out The output, which must hold count samples
+ */
+void convert_s16_to_f32(s16 const *in, usize count, f32 *out);
+
+/**
+ * Converts float samples to signed 16 bit samples, rounding to nearest and saturating at full scale
+ * @param in The input samples
+ * @param count The amount of samples
+ * @param out The output, which must hold count samples
+ */
+void convert_f32_to_s16(f32 const *in, usize count, s16 *out);
+
+#endif// RESAMPLE_H
@@ -0,0 +1,175 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "segment_writer.h"
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// How long whisper waits before it retries to queue a segment, only if the queue is full
+constexpr auto BACKPRESSURE_WAIT = std::chrono::milliseconds{ 1 };
+
+// How long the writer thread sleeps at most if there is nothing to do
+constexpr auto IDLE_WAIT = std::chrono::seconds{ 1 };
+
+}// anonymous namespace
+
+SegmentWriter::SegmentWriter(BlockingBidiReactor<transcriber::Chunk, transcriber::Transcript> *stream,
+                             PersistenceSessions *persistence,
+                             std::string transcription_id,
+                             std::string user_id,
+                             transcriber::Profile const profile,
+                             SegmentWriterOptions const &options,
+                             SegmentWriterMetrics &metrics)
+    : m_stream{ stream },
+      m_persistence{ persistence },
+      m_transcription_id{ std::move(transcription_id) },
+      m_user_id{ std::move(user_id) },
+      m_profile{ profile },
+      m_options{ options },
+      m_metrics{ metrics },
+      m_queue{ options.queue_capacity },
+      m_sleeping{ false },
+      m_closed{ false },
+      m_batch_time{ 0 },
+      m_first{ true } {
+    m_thread = std::thread{ [this] { run(); } };
+}
+
+SegmentWriter::~SegmentWriter() {
+    finish();
+}
+
+void SegmentWriter::push(std::string text) {
+    Segment segment{ .text = std::move(text), .time = std::time(nullptr) };
+
+    // The gauge is raised first, so the writer thread never lowers it below zero
+    auto const queued = ++m_metrics.queued;
+    auto peak = m_metrics.peak_queued.load();
+    while (queued > peak and not m_metrics.peak_queued.compare_exchange_weak(peak, queued)) { }
+
+    // Whisper only waits for the writer thread if it is that far behind
+    if (not m_queue.try_push(segment)) {
+        ++m_metrics.stalls;
+        do {
+            std::this_thread::sleep_for(BACKPRESSURE_WAIT);
+        } while (not m_queue.try_push(segment));
+    }
+
+    // The lock is only taken to wake up the writer thread, the fence orders the push before reading the flag
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping) {
+        std::lock_guard lock{ m_mutex };
+        m_wakeup.notify_one();
+    }
+}
+
+void SegmentWriter::finish() {
+    if (not m_thread.joinable()) {
+        return;
+    }
+
+    m_closed = true;
+    {
+        std::lock_guard lock{ m_mutex };
+        m_wakeup.notify_one();
+    }
+    m_thread.join();
+}
+
+void SegmentWriter::run() {
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    while (true) {
+        if (auto segment = m_queue.try_pop()) {
+            --m_metrics.queued;
+            ++m_metrics.segments;
+
+            // Prepare the transcript chunk and write it to the caller
+            transcriber::Transcript transcript;
+            transcript.set_id(m_transcription_id);
+            transcript.set_text(segment->text);
+            transcript.set_profile(m_profile);
+            m_stream->Write(transcript);
+
+            // The first segment is persisted on its own, as persistence measures the duration from its time
+            if (m_batch.empty()) {
+                deadline = std::chrono::steady_clock::now() + m_options.batch_delay;
+            } else {
+                m_batch += ' ';
+            }
+            m_batch += segment->text;
+            m_batch_time = segment->time;
+            if (m_first or m_batch.size() >= m_options.batch_bytes) {
+                flush();
+            }
+            continue;
+        }
+
+        auto const now = std::chrono::steady_clock::now();
+        if (not m_batch.empty() and now >= deadline) {
+            flush();
+        }
+
+        // The producer is done, but the queue is drained completely before the writer stops
+        if (m_closed) {
+            if (m_queue.size() == 0) {
+                break;
+            }
+            continue;
+        }
+
+        std::unique_lock lock{ m_mutex };
+        m_sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_queue.size() == 0 and not m_closed) {
+            m_wakeup.wait_until(lock, m_batch.empty() ? now + IDLE_WAIT : deadline);
+        }
+        m_sleeping = false;
+    }
+
+    // Persistence saves the transcript once its end arrives, transcripts without any segment are not saved
+    flush();
+    if (m_persistence and not m_first) {
+        m_persistence->finish(PersistenceKind::Transcript, m_transcription_id, "", m_user_id);
+    }
+}
+
+void SegmentWriter::flush() {
+    if (m_batch.empty()) {
+        return;
+    }
+
+    if (m_persistence) {
+        persistence::Chunk persistence_chunk;
+        persistence_chunk.set_transcriptid(m_transcription_id);
+        persistence_chunk.set_userid(m_user_id);
+        persistence_chunk.set_text(m_batch);
+        persistence_chunk.set_time(m_batch_time);
+        m_persistence->write(PersistenceKind::Transcript, std::move(persistence_chunk));
+        ++m_metrics.chunks;
+    }
+
+    m_batch.clear();
+    m_first = false;
+}
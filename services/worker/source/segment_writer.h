@@ -0,0 +1,162 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef SEGMENT_WRITER_H
+#define SEGMENT_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <transcriber.grpc.pb.h>
+
+#include "blocking_reactor.h"
+#include "persistence_sessions.h"
+#include "types.h"
+#include "utils/spsc_queue.h"
+
+/**
+ * Options of the segment writers
+ */
+struct SegmentWriterOptions {
+    // The amount of segments that may wait to be written, whisper blocks once they are exceeded
+    usize queue_capacity = 1024;
+
+    // Segments are coalesced into one persistence chunk until the text reaches this size ...
+    usize batch_bytes = 4096;
+
+    // ... or the oldest segment of the chunk waited this long
+    std::chrono::milliseconds batch_delay{ 500 };
+};
+
+/**
+ * Counters that are shared by the segment writers of all requests
+ */
+struct SegmentWriterMetrics {
+    // The amount of segments that currently wait to be written, and the most that ever waited at once
+    std::atomic<u64> queued{ 0 };
+    std::atomic<u64> peak_queued{ 0 };
+
+    // The amount of segments that were written and of the persistence chunks they were coalesced into
+    std::atomic<u64> segments{ 0 };
+    std::atomic<u64> chunks{ 0 };
+
+    // The amount of times whisper had to wait, because a queue was full
+    std::atomic<u64> stalls{ 0 };
+};
+
+/**
+ * The SegmentWriter writes the segments of one transcription to the caller and to persistence on a dedicated
+ * thread, so whisper never blocks on network I/O. The segments are passed through a lock-free queue and
+ * coalesced into fewer persistence chunks. The chunks are joined with a space by persistence, hence their
+ * text is joined the same way and the stored transcript stays the same.
+ */
+class SegmentWriter {
+public:
+    /**
+     * Starts the writer thread
+     * @param stream The stream to the caller
+     * @param persistence The persistence sessions, nullptr to not persist the transcript
+     * @param transcription_id The ID of the transcription
+     * @param user_id The ID of the user that initiated the transcription
+     * @param profile The profile that is applied to the transcription, which is reported back to the caller
+     * @param options The writer options
+     * @param metrics The metrics that are updated by the writer
+     */
+    SegmentWriter(BlockingBidiReactor<transcriber::Chunk, transcriber::Transcript> *stream,
+                  PersistenceSessions *persistence,
+                  std::string transcription_id,
+                  std::string user_id,
+                  transcriber::Profile profile,
+                  SegmentWriterOptions const &options,
+                  SegmentWriterMetrics &metrics);
+
+    /**
+     * Writes the remaining segments and marks the end of the transcript for persistence
+     */
+    ~SegmentWriter();
+
+    SegmentWriter(SegmentWriter const &) = delete;
+    SegmentWriter &operator=(SegmentWriter const &) = delete;
+
+    /**
+     * Queues a segment, blocks only if the queue is full. Must always be called from the same thread.
+     * @param text The text of the segment
+     */
+    void push(std::string text);
+
+    /**
+     * Writes the remaining segments and marks the end of the transcript for persistence,
+     * the writer must not be used afterwards
+     */
+    void finish();
+
+private:
+    /**
+     * A segment that waits to be written
+     */
+    struct Segment {
+        std::string text;
+        std::time_t time;
+    };
+
+    /**
+     * The loop of the writer thread
+     */
+    void run();
+
+    /**
+     * Queues the coalesced segments for persistence
+     */
+    void flush();
+
+    BlockingBidiReactor<transcriber::Chunk, transcriber::Transcript> *m_stream;
+    PersistenceSessions *m_persistence;
+    std::string m_transcription_id;
+    std::string m_user_id;
+    transcriber::Profile m_profile;
+    SegmentWriterOptions m_options;
+    SegmentWriterMetrics &m_metrics;
+
+    utils::SpscQueue<Segment> m_queue;
+
+    // The writer thread only sleeps on the condition variable if the queue is empty
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::atomic<bool> m_sleeping;
+    std::atomic<bool> m_closed;
+
+    // Only accessed by the writer thread
+    std::string m_batch;
+    std::time_t m_batch_time;
+    bool m_first;
+
+    std::thread m_thread;
+};
+
+#endif// SEGMENT_WRITER_H
@@ -0,0 +1,106 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "stream_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+StreamBuffer::StreamBuffer(usize const capacity)
+    : m_offset{ 0 },
+      m_buffered{ 0 },
+      m_capacity{ capacity },
+      m_closed{ false },
+      m_cancelled{ false } { }
+
+bool StreamBuffer::write(std::string chunk) {
+    if (chunk.empty()) {
+        return true;
+    }
+
+    std::unique_lock lock{ m_mutex };
+
+    // A chunk larger than the capacity is still accepted once the buffer is drained, otherwise we would deadlock
+    m_writable.wait(lock, [this, &chunk] {
+        return m_cancelled or m_buffered == 0 or m_buffered + chunk.size() <= m_capacity;
+    });
+
+    if (m_cancelled) {
+        return false;
+    }
+
+    m_buffered += chunk.size();
+    m_chunks.push_back(std::move(chunk));
+    m_readable.notify_one();
+    return true;
+}
+
+void StreamBuffer::close() {
+    std::scoped_lock lock{ m_mutex };
+    m_closed = true;
+    m_readable.notify_all();
+}
+
+void StreamBuffer::cancel() {
+    std::scoped_lock lock{ m_mutex };
+    m_cancelled = true;
+    m_chunks.clear();
+    m_buffered = 0;
+    m_writable.notify_all();
+}
+
+usize StreamBuffer::read(u8 *buffer, usize const size) {
+    std::unique_lock lock{ m_mutex };
+    m_readable.wait(lock, [this] { return m_cancelled or m_closed or not m_chunks.empty(); });
+
+    // Copy as much as possible from the buffered chunks, the front chunk may already be partially consumed
+    usize read = 0;
+    while (read < size and not m_chunks.empty()) {
+        auto const &front = m_chunks.front();
+        auto const to_copy = std::min(size - read, front.size() - m_offset);
+        std::memcpy(buffer + read, front.data() + m_offset, to_copy);
+        read += to_copy;
+        m_offset += to_copy;
+
+        if (m_offset == front.size()) {
+            m_buffered -= front.size();
+            m_chunks.pop_front();
+            m_offset = 0;
+        }
+    }
+
+    m_writable.notify_one();
+    return read;
+}
+
+ssize StreamBuffer::seek(ssize, int) {
+    return -1;
+}
+
+ssize StreamBuffer::size() const {
+    return -1;
+}
+
+bool StreamBuffer::seekable() const {
+    return false;
+}
@@ -0,0 +1,83 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "decode.h"
+
+/**
+ * The StreamBuffer is a bounded producer/consumer buffer for media bytes.
+ * The producer (usually the gRPC reader) appends chunks while the consumer
+ * (the decoder) reads them, which allows decoding to run while the upload
+ * is still arriving. The buffer never holds more than its capacity, so the
+ * producer is blocked until the decoder catches up.
+ */
+class StreamBuffer final : public MediaSource {
+public:
+    /**
+     * Instantiates a new stream buffer
+     * @param capacity The maximum amount of buffered bytes
+     */
+    explicit StreamBuffer(usize capacity);
+
+    /**
+     * Appends a chunk to the buffer, blocking while the buffer is full
+     * @param chunk The chunk, which is moved into the buffer
+     * @return False if the consumer cancelled the buffer, true otherwise
+     */
+    bool write(std::string chunk);
+
+    /**
+     * Signals the consumer that no more chunks will be written
+     */
+    void close();
+
+    /**
+     * Signals the producer that no more chunks will be read
+     */
+    void cancel();
+
+    [[nodiscard]] usize read(u8 *buffer, usize size) override;
+    [[nodiscard]] ssize seek(ssize offset, int whence) override;
+    [[nodiscard]] ssize size() const override;
+    [[nodiscard]] bool seekable() const override;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_readable;
+    std::condition_variable m_writable;
+    std::deque<std::string> m_chunks;
+    usize m_offset;
+    usize m_buffered;
+    usize m_capacity;
+    bool m_closed;
+    bool m_cancelled;
+};
+
+#endif// STREAM_BUFFER_H
@@ -29,6 +29,9 @@
 #include "utils/continuation.h"
 #include "utils/uuid.h"
 
+// The amount of model listings that run at once, they are short and independent of the summaries
+constexpr usize MODELS_THREADS = 1;
+
 // This message is passed to the OpenAI instance as a developer suggestion to the model
 constexpr auto COMPLETION_DEV_MESSAGE = R"(
 Summarize this meeting transcription with **maximum accuracy and clarity**. The summary **must** include:
@@ -44,39 +47,37 @@ Do not miss anything important. **Precision is critical.**
 
 SummarizerService::SummarizerService(std::string endpoint,
                                      std::string token,
-                                     std::shared_ptr<persistence::Persistence::Stub> stub)
+                                     std::shared_ptr<PersistenceSessions> persistence,
+                                     usize const threads)
     : m_client{ std::move(endpoint), std::move(token) },
-      m_persistence_stub{ std::move(stub) } { }
+      m_persistence{ std::move(persistence) },
+      m_request_pool{ threads },
+      m_models_pool{ MODELS_THREADS } { }
 
-grpc::Status SummarizerService::summarize(grpc::ServerContext *context,
-                                          summarizer::Prompt const *request,
-                                          grpc::ServerWriter<summarizer::Summary> *writer) {
+grpc::ServerWriteReactor<summarizer::Summary> *SummarizerService::summarize(grpc::CallbackServerContext *,
+                                                                            summarizer::Prompt const *request) {
     spdlog::info("Incoming summarize request");
 
-    // Initialize the client context required to perform calls to the gRPC persistence service
-    grpc::ClientContext persist_context;
-    google::protobuf::Empty persist_response;
+    // The request and the reactor stay alive until the reactor is finished
+    auto *writer = new Stream;
+    m_request_pool.submit([this, request, writer] { writer->Finish(summarize(request, writer)); });
+    return writer;
+}
 
-    // Initialize the client writer required to perform calls to the gRPC persistence service
-    auto persist_writer = m_persistence_stub->persistSummary(&persist_context, &persist_response);
+grpc::Status SummarizerService::summarize(summarizer::Prompt const *request, Stream *writer) {
+    // Generate a summary ID for correlation
+    auto const summary_id = utils::UUID::generate_v4();
 
-    // This continuation makes sure that the writer is properly dealt with, no matter what happens via RAII
-    auto persist_finish = utils::Continuation{ [&persist_writer] {
-        if (not persist_writer) {
+    // This continuation makes sure that persistence saves the summary, no matter what happens via RAII
+    auto persisted = false;
+    auto persist_finish = utils::Continuation{ [this, request, &persisted, &summary_id] {
+        if (not persisted) {
             return;
         }
 
-        persist_writer->WritesDone();
-        persist_writer->Finish();
+        m_persistence->finish(PersistenceKind::Summary, request->transcriptid(), summary_id, request->userid());
     } };
 
-    if (not persist_writer) {
-        spdlog::error("Cannot persist transcription, unable to establish connection!");
-    }
-
-    // Generate a summary ID for correlation
-    auto const summary_id = utils::UUID::generate_v4();
-
     // Prepare the completion request to pass to the OpenAI instance
     CompletionRequest completion_request;
     completion_request.model = request->model();
@@ -86,7 +87,7 @@ grpc::Status SummarizerService::summarize(grpc::ServerContext *context,
 
     // Perform the actual completion call with our custom callback
     auto const result = m_client.completion(completion_request,
-                                            [request, writer, &persist_writer, summary_id](std::string message) {
+                                            [this, request, writer, &persisted, summary_id](std::string message) {
                                                 spdlog::debug("Received summary chunk of size {}", message.size());
 
                                                 // Prepare the summary chunk and configure the message
@@ -94,17 +95,17 @@ grpc::Status SummarizerService::summarize(grpc::ServerContext *context,
                                                 summary.set_text(message);
                                                 writer->Write(summary);
 
-                                                // If the persistence writer is configured, write the chunk to
-                                                // persistence
-                                                if (persist_writer) {
-                                                    persistence::Chunk persistence_chunk;
-                                                    persistence_chunk.set_transcriptid(request->transcriptid());
-                                                    persistence_chunk.set_summaryid(summary_id);
-                                                    persistence_chunk.set_userid(request->userid());
-                                                    persistence_chunk.set_text(message);
-                                                    persistence_chunk.set_time(std::time(nullptr));
-                                                    persist_writer->Write(persistence_chunk);
-                                                }
+                                                // Queue the chunk for persistence, it is written in the
+                                                // background
+                                                persistence::Chunk persistence_chunk;
+                                                persistence_chunk.set_transcriptid(request->transcriptid());
+                                                persistence_chunk.set_summaryid(summary_id);
+                                                persistence_chunk.set_userid(request->userid());
+                                                persistence_chunk.set_text(message);
+                                                persistence_chunk.set_time(std::time(nullptr));
+                                                m_persistence->write(PersistenceKind::Summary,
+                                                                     std::move(persistence_chunk));
+                                                persisted = true;
                                             });
 
     // If the completion call failed, return an error to the caller
@@ -117,11 +118,19 @@ grpc::Status SummarizerService::summarize(grpc::ServerContext *context,
     return grpc::Status::OK;
 }
 
-grpc::Status SummarizerService::models(grpc::ServerContext *context,
-                                       google::protobuf::Empty const *request,
-                                       summarizer::Models *response) {
+grpc::ServerUnaryReactor *SummarizerService::models(grpc::CallbackServerContext *context,
+                                                    google::protobuf::Empty const *,
+                                                    summarizer::Models *response) {
     spdlog::info("Incoming models request");
 
+    // Listing the models is a blocking call to the OpenAI endpoint as well, but it must not wait behind the
+    // streamed summaries on the request pool, so it runs on its own small executor
+    auto *reactor = context->DefaultReactor();
+    m_models_pool.submit([this, reactor, response] { reactor->Finish(models(response)); });
+    return reactor;
+}
+
+grpc::Status SummarizerService::models(summarizer::Models *response) {
     // Asks the OpenAI instance for the available models
     auto const result = m_client.models();
 
@@ -138,9 +147,11 @@ grpc::Status SummarizerService::models(grpc::ServerContext *context,
     return grpc::Status::OK;
 }
 
-grpc::Status SummarizerService::heartbeat(grpc::ServerContext *context,
-                                          const google::protobuf::Empty *request,
-                                          google::protobuf::Empty *response) {
+grpc::ServerUnaryReactor *SummarizerService::heartbeat(grpc::CallbackServerContext *context,
+                                                       const google::protobuf::Empty *,
+                                                       google::protobuf::Empty *) {
     spdlog::info("Incoming summarizer heartbeat, respond with OK");
-    return grpc::Status::OK;
+    auto *reactor = context->DefaultReactor();
+    reactor->Finish(grpc::Status::OK);
+    return reactor;
 }
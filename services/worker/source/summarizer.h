@@ -26,53 +26,85 @@
 
 #include "openai.h"
 
-#include <persistence.grpc.pb.h>
 #include <summarizer.grpc.pb.h>
 
-struct SummarizerService final : summarizer::Summarizer::Service {
+#include "blocking_reactor.h"
+#include "persistence_sessions.h"
+#include "utils/thread_pool.h"
+
+/**
+ * The SummarizerService defines a gRPC service in order for the other services to summarize transcripts.
+ * The calls to the OpenAI endpoint run on a request pool, they never occupy the threads of the gRPC server.
+ * Model listings have their own executor, so they are answered while every summary thread is busy.
+ */
+struct SummarizerService final : summarizer::Summarizer::CallbackService {
     /**
      * Instantiates a new summarizer gRPC service
      * @param endpoint The OpenAI endpoint
      * @param token The JWT token for authentication at the endpoint
-     * @param stub The stub for the persistence service
+     * @param persistence The sessions to the persistence service
+     * @param threads The amount of calls to the OpenAI endpoint that run at once
      */
-    SummarizerService(std::string endpoint, std::string token, std::shared_ptr<persistence::Persistence::Stub> stub);
+    SummarizerService(std::string endpoint,
+                      std::string token,
+                      std::shared_ptr<PersistenceSessions> persistence,
+                      usize threads);
 
     /**
-     * Summarizes a given text
+     * Summarizes a given text on the request pool
      * @param context The server context
      * @param request The summarize request
-     * @param writer The response writer
-     * @return A grpc status
+     * @return The reactor of the call
      */
-    grpc::Status summarize(grpc::ServerContext *context,
-                           summarizer::Prompt const *request,
-                           grpc::ServerWriter<summarizer::Summary> *writer) override;
+    grpc::ServerWriteReactor<summarizer::Summary> *summarize(grpc::CallbackServerContext *context,
+                                                             summarizer::Prompt const *request) override;
 
     /**
-     * Retrieves a list of the available OpenAI models
+     * Retrieves a list of the available OpenAI models on the models pool
      * @param context The server context
      * @param request The request, which is empty
      * @param response The response, which contains a list of models
+     * @return The reactor of the call
      */
-    grpc::Status models(grpc::ServerContext *context,
-                        google::protobuf::Empty const *request,
-                        summarizer::Models *response) override;
+    grpc::ServerUnaryReactor *models(grpc::CallbackServerContext *context,
+                                     google::protobuf::Empty const *request,
+                                     summarizer::Models *response) override;
 
     /**
      * Endpoint for checking whether the summarizer service is running
      * @param context The server context
      * @param request The heartbeat request, which is empty
      * @param response The response, which is empty
-     * @return A grpc status
+     * @return The reactor of the call
      */
-    grpc::Status heartbeat(grpc::ServerContext *context,
-                           google::protobuf::Empty const *request,
-                           google::protobuf::Empty *response) override;
+    grpc::ServerUnaryReactor *heartbeat(grpc::CallbackServerContext *context,
+                                        google::protobuf::Empty const *request,
+                                        google::protobuf::Empty *response) override;
 
 private:
+    using Stream = BlockingWriteReactor<summarizer::Summary>;
+
+    /**
+     * Summarizes a given text, runs on a thread of the request pool
+     * @param request The summarize request
+     * @param writer The response writer
+     * @return A grpc status
+     */
+    grpc::Status summarize(summarizer::Prompt const *request, Stream *writer);
+
+    /**
+     * Retrieves a list of the available OpenAI models, runs on the thread of the models pool
+     * @param response The response, which contains a list of models
+     * @return A grpc status
+     */
+    grpc::Status models(summarizer::Models *response);
+
     OpenAI m_client;
-    std::shared_ptr<persistence::Persistence::Stub> m_persistence_stub;
+    std::shared_ptr<PersistenceSessions> m_persistence;
+
+    // Declared last, so the running calls are completed before anything they use is destroyed
+    utils::ThreadPool m_request_pool;
+    utils::ThreadPool m_models_pool;
 };
 
 #endif// SUMMARIZER_H
@@ -21,12 +21,21 @@
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 //  SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <thread>
+
 #include <spdlog/spdlog.h>
 
 #include "decode.h"
 #include "transcriber.h"
+#include "upload.h"
+#include "vad.h"
+#include "whisper_params.h"
 
-#include "utils/continuation.h"
+#include "utils/hash.h"
 #include "utils/uuid.h"
 
 namespace {
@@ -40,6 +49,15 @@ constexpr auto CHUNK_DURATION = 30;
 // The chunk size in bytes is determined by the sample rate and chunk duration
 constexpr auto CHUNK_SIZE = SAMPLE_RATE * CHUNK_DURATION;
 
+// Whisper uses at most half of its text context for the prompt, which is 224 tokens for all models
+constexpr usize MAX_PROMPT_TOKENS = 224;
+
+// Windows cost at least this share of a full window at the whisper states, as the encoder context has a minimum size
+constexpr f64 MIN_WINDOW_COST = 0.25;
+
+// Whether there may be a transcript of the same audio in another encoding is told by the first two minutes
+constexpr usize FINGERPRINT_PREFIX_SIZE = SAMPLE_RATE * 120;
+
 /**
  * The TranscribeContext encapsulates all transcription relevant data in one struct
  * in order for the segment callback of whisper to access all relevant information.
@@ -48,144 +66,629 @@ constexpr auto CHUNK_SIZE = SAMPLE_RATE * CHUNK_DURATION;
  * segment callback.
  */
 struct TranscribeContext {
-    // The ID of the transcription. This is required for the call to the persistence gRPC service.
-    std::string transcription_id;
+    // Writes the segments to the caller and to the persistence service without blocking whisper.
+    SegmentWriter *writer;
 
-    // The ID of the user which initiated the transcription. This is required for the call to the persistence gRPC
-    // service.
-    std::string user_id;
+    // Collects the segments for the transcript cache, nullptr if the transcript is not cached.
+    std::vector<std::string> *segments;
+};
 
-    // The gRPC interface for passing the segments to the caller.
-    grpc::ServerReaderWriter<transcriber::Transcript, transcriber::Chunk> *stream;
+/**
+ * Writes a transcribed segment to the caller and, if configured, to persistence
+ * @param context The context of the transcription
+ * @param text The text of the segment
+ */
+void write_segment(TranscribeContext const &context, char const *text) {
+    // The writer thread performs the actual writes, whisper only waits if it is far behind
+    context.writer->push(text);
 
-    // The gRPC interface for writing the newly generated transcription chunks to the persistence service.
-    grpc::ClientWriter<persistence::Chunk> *persistence_writer;
-};
+    if (context.segments) {
+        context.segments->emplace_back(text);
+    }
+}
+
+/**
+ * Writes the segments of a transcript that was transcribed before
+ * @param context The context of the transcription
+ * @param segments The texts of the segments
+ */
+void replay_segments(TranscribeContext context, std::vector<std::string> const &segments) {
+    context.segments = nullptr;
+    for (auto const &segment: segments) {
+        write_segment(context, segment.c_str());
+    }
+}
+
+/**
+ * Fingerprints the whole audio of a media on a decoder of its own
+ * @param factory Creates the media source
+ * @param options The decode options
+ * @return The fingerprint or an error if the media cannot be decoded
+ */
+Result<Fingerprint> fingerprint_media(MediaSourceFactory const &factory, DecodeOptions const &options) {
+    auto const source = factory();
+    auto pcm_stream = PcmStream::open(*source, options);
+    if (not pcm_stream) {
+        return tl::unexpected(pcm_stream.error());
+    }
+
+    Fingerprinter fingerprinter;
+    for (auto window = pcm_stream->next_window(CHUNK_SIZE); not window.empty();
+         window = pcm_stream->next_window(CHUNK_SIZE)) {
+        fingerprinter.feed(window);
+    }
+    return fingerprinter.finish();
+}
 
 /**
  * Handles a newly generated segment, which is a transcription chunk
- * @param ctx The context of whisper
+ * @param state The whisper state of the transcription
  * @param n_new Indicates where the new segments start
  * @param user_data The user data, which is our TranscribeContext handle
  */
-void handle_segment(whisper_context *ctx, whisper_state *, int const n_new, void *user_data) {
+void handle_segment(whisper_context *, whisper_state *state, int const n_new, void *user_data) {
     // Retrieve the TranscribeContext from the user data argument of whisper
-    auto *context = static_cast<TranscribeContext *>(user_data);
-    auto const n_segments = whisper_full_n_segments(ctx);
+    auto const *context = static_cast<TranscribeContext const *>(user_data);
+    auto const n_segments = whisper_full_n_segments_from_state(state);
 
     // Loop over all new segments
     for (int i = n_segments - n_new; i < n_segments; ++i) {
-        // Read the newly generated text chunk
-        auto const *text = whisper_full_get_segment_text(ctx, i);
         spdlog::debug("Writing transcript segment: {}", i);
+        write_segment(*context, whisper_full_get_segment_text_from_state(state, i));
+    }
+}
 
-        // Prepare the transcript chunk and write it to the caller
-        transcriber::Transcript transcript;
-        transcript.set_id(context->transcription_id);
-        transcript.set_text(text);
-        context->stream->Write(transcript);
+/**
+ * Collects newly generated segments of a window that is transcribed concurrently to other windows.
+ * The segments are written later on, once all earlier windows are written.
+ * @param state The whisper state of the window
+ * @param n_new Indicates where the new segments start
+ * @param user_data The user data, which is the vector of segment texts of the window
+ */
+void collect_segment(whisper_context *, whisper_state *state, int const n_new, void *user_data) {
+    auto *segments = static_cast<std::vector<std::string> *>(user_data);
+    auto const n_segments = whisper_full_n_segments_from_state(state);
+    for (int i = n_segments - n_new; i < n_segments; ++i) {
+        segments->emplace_back(whisper_full_get_segment_text_from_state(state, i));
+    }
+}
 
-        // If the persistence writer is configured, write the chunk to persistence
-        if (context->persistence_writer) {
-            persistence::Chunk persistence_chunk;
-            persistence_chunk.set_transcriptid(context->transcription_id);
-            persistence_chunk.set_userid(context->user_id);
-            persistence_chunk.set_text(text);
-            persistence_chunk.set_time(std::time(nullptr));
-            context->persistence_writer->Write(persistence_chunk);
+/**
+ * The WindowSession carries state from one window to the next window of a request, so that
+ * the windows are not transcribed cold. The language is detected once, on the first window
+ * with speech, and pinned afterwards. The trailing tokens of the previous window prompt the
+ * decoder of the next window.
+ */
+struct WindowSession {
+    // The detected language, nullptr until a window with speech was transcribed
+    char const *language = nullptr;
+
+    // The trailing text tokens of the last window with speech
+    std::vector<whisper_token> prompt_tokens;
+
+    /**
+     * Applies the session to the parameters of the next window
+     * @param params The whisper parameters, which must not outlive the session
+     */
+    void apply(whisper_full_params &params) const {
+        if (language) {
+            params.language = language;
+            params.detect_language = false;
+        }
+
+        if (not prompt_tokens.empty()) {
+            params.prompt_tokens = prompt_tokens.data();
+            params.prompt_n_tokens = static_cast<int>(prompt_tokens.size());
         }
     }
+
+    /**
+     * Updates the session with the result of a transcribed window
+     * @param context The whisper context
+     * @param state The whisper state, which holds the result of the window
+     */
+    void update(whisper_context *context, whisper_state *state) {
+        auto const n_segments = whisper_full_n_segments_from_state(state);
+        if (n_segments == 0) {
+            return;
+        }
+
+        if (not language) {
+            language = whisper_lang_str(whisper_full_lang_id_from_state(state));
+            spdlog::debug("Detected language {}, pinned for the remaining windows", language);
+        }
+
+        // Special tokens (timestamps, end of text, etc.) are not part of the prompt
+        auto const eot = whisper_token_eot(context);
+        prompt_tokens.clear();
+        for (int i = 0; i < n_segments; ++i) {
+            auto const n_tokens = whisper_full_n_tokens_from_state(state, i);
+            for (int j = 0; j < n_tokens; ++j) {
+                if (auto const token = whisper_full_get_token_id_from_state(state, i, j); token < eot) {
+                    prompt_tokens.push_back(token);
+                }
+            }
+        }
+
+        if (prompt_tokens.size() > MAX_PROMPT_TOKENS) {
+            prompt_tokens.erase(prompt_tokens.begin(),
+                                prompt_tokens.end() - static_cast<std::ptrdiff_t>(MAX_PROMPT_TOKENS));
+        }
+    }
+};
+
+/**
+ * Digests the options that change the transcript of the same upload with the same model and profile,
+ * so that transcripts of another configuration are not reused
+ * @param options The transcriber configuration
+ * @return The digest, which is safe to use as part of a file name
+ */
+std::string transcript_settings(TranscriberOptions const &options) {
+    // Concurrent windows never carry the context from one window to the next
+    auto const settings = std::format("audio_only={},fast_resample={},vad={},boundary_tolerance_ms={},"
+                                      "adaptive_audio_ctx={},carry_context={},parallel_windows={}",
+                                      options.decode.audio_only, options.decode.fast_resample,
+                                      static_cast<bool>(options.voice_detector), options.boundary_tolerance_ms,
+                                      options.adaptive_audio_ctx,
+                                      options.carry_context and options.parallel_windows <= 1,
+                                      options.parallel_windows > 1);
+    utils::XXHash64 hash;
+    hash.update(settings.data(), settings.size());
+    return std::format("{:016x}", hash.digest());
+}
+
+/**
+ * The user on whose behalf the windows of a request are transcribed
+ */
+struct Tenant {
+    std::string user;
+
+    // The share of the user at the whisper states relative to other users
+    f64 weight;
+};
+
+/**
+ * Checks out a whisper state for a window once it is the turn of the user
+ * @param pool The pool that provides the whisper states
+ * @param tenant The user of the request
+ * @param samples The amount of samples in the window
+ * @param adaptive_audio_ctx Whether the audio context is sized to the window, so short windows cost less
+ * @return The lease of the state
+ */
+WhisperPool::Lease acquire_window(WhisperPool &pool,
+                                  Tenant const &tenant,
+                                  usize const samples,
+                                  bool const adaptive_audio_ctx) {
+    auto const cost = adaptive_audio_ctx ? std::max(static_cast<f64>(samples) / CHUNK_SIZE, MIN_WINDOW_COST) : 1.0;
+    return pool.acquire(tenant.user, tenant.weight, cost);
+}
+
+/**
+ * The outcome of transcribing the windows of a request
+ */
+struct Transcribed {
+    // The amount of transcribed samples
+    usize samples;
+
+    // The time that whisper spent on the windows, without waiting for a whisper state
+    f64 compute_seconds;
+};
+
+/**
+ * The segments of a window that was transcribed concurrently to other windows
+ */
+struct TranscribedWindow {
+    std::vector<std::string> segments;
+    f64 compute_seconds;
+};
+
+/**
+ * Stops whisper once the caller cancelled the request or its deadline passed
+ * @param user_data The server context of the request
+ * @return Whether whisper stops
+ */
+bool abort_cancelled(void *user_data) {
+    return static_cast<grpc::CallbackServerContext *>(user_data)->IsCancelled();
+}
+
+/**
+ * Transcribes the speech stream window by window, writing the segments while they are generated
+ * @param speech_stream The speech stream of the upload
+ * @param pool The pool that provides the whisper states
+ * @param tenant The user of the request
+ * @param params The whisper parameters, whose segment callback writes to the context
+ * @param adaptive_audio_ctx Whether the audio context is sized to the windows
+ * @param carry_context Whether the language and prompt are carried from one window to the next
+ * @return The amount of transcribed samples and the time whisper spent on them, or an error
+ */
+Result<Transcribed> transcribe_sequential(SpeechStream &speech_stream,
+                                          WhisperPool &pool,
+                                          Tenant const &tenant,
+                                          whisper_full_params params,
+                                          bool const adaptive_audio_ctx,
+                                          bool const carry_context) {
+    // Decode the PCM samples window by window to avoid overloading whisper and to keep the memory bounded
+    // The samples are kept as 16 bit PCM, only the current window is converted to float
+    usize offset = 0;
+    f64 compute_seconds = 0.0;
+    std::vector<f32> samples;
+    WindowSession session;
+    for (auto window = speech_stream.next_window(CHUNK_SIZE); not window.empty();
+         window = speech_stream.next_window(CHUNK_SIZE)) {
+        pcm_to_f32(window, samples);
+        if (carry_context) {
+            session.apply(params);
+        }
+
+        // Check out a whisper state, other requests transcribe on the remaining states meanwhile
+        // Once the states are contended, the users take turns window by window
+        auto const whisper = acquire_window(pool, tenant, samples.size(), adaptive_audio_ctx);
+        if (adaptive_audio_ctx) {
+            params.audio_ctx = fit_audio_ctx(whisper.context(), samples.size());
+        }
+
+        // This performs the actual transcription
+        auto const window_started = std::chrono::steady_clock::now();
+        auto const failed = whisper_full_with_state(whisper.context(), whisper.state(), params, samples.data(),
+                                                    static_cast<int>(samples.size())) != 0;
+        compute_seconds += std::chrono::duration<f64>(std::chrono::steady_clock::now() - window_started).count();
+        if (failed) {
+            spdlog::error("Failed to transcribe chunk at offset {} ({} samples)", speech_stream.source_position(offset),
+                          window.size());
+            return tl::unexpected("Failed to transcribe audio chunk");
+        }
+
+        if (carry_context) {
+            session.update(whisper.context(), whisper.state());
+        }
+
+        spdlog::debug("Transcribed chunk at offset {} ({} samples)", speech_stream.source_position(offset),
+                      window.size());
+        offset += window.size();
+    }
+    return Transcribed{ .samples = offset, .compute_seconds = compute_seconds };
+}
+
+/**
+ * Transcribes up to max_windows windows of the PCM stream concurrently. The segments of every
+ * window are buffered and written in chronological order, as soon as all earlier windows are written.
+ * @param speech_stream The speech stream of the upload
+ * @param pool The pool that provides the whisper states
+ * @param tenant The user of the request
+ * @param window_pool The thread pool on which the windows are transcribed
+ * @param max_windows The maximum amount of windows in flight
+ * @param params The whisper parameters
+ * @param adaptive_audio_ctx Whether the audio context is sized to the windows
+ * @param context The context to which the segments are written
+ * @return The amount of transcribed samples and the time whisper spent on them, or an error
+ */
+Result<Transcribed> transcribe_parallel(SpeechStream &speech_stream,
+                                        WhisperPool &pool,
+                                        Tenant const &tenant,
+                                        utils::ThreadPool &window_pool,
+                                        usize const max_windows,
+                                        whisper_full_params const &params,
+                                        bool const adaptive_audio_ctx,
+                                        TranscribeContext const &context) {
+    // The reorder buffer holds the windows in flight in chronological order
+    std::deque<std::future<Result<TranscribedWindow>>> in_flight;
+    f64 compute_seconds = 0.0;
+
+    auto const write_front = [&]() -> Result<void> {
+        auto transcribed = in_flight.front().get();
+        in_flight.pop_front();
+        if (not transcribed) {
+            return tl::unexpected(transcribed.error());
+        }
+
+        for (auto const &text : transcribed->segments) {
+            write_segment(context, text.c_str());
+        }
+        compute_seconds += transcribed->compute_seconds;
+        return {};
+    };
+
+    // The windows in flight use the whisper pool and the parameters, so they are waited for before returning
+    auto const fail = [&](std::string error) -> Result<Transcribed> {
+        for (auto const &window : in_flight) {
+            window.wait();
+        }
+        return tl::unexpected(std::move(error));
+    };
+
+    auto const front_ready = [&] {
+        return not in_flight.empty() and
+               in_flight.front().wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+    };
+
+    usize offset = 0;
+    for (auto window = speech_stream.next_window(CHUNK_SIZE); not window.empty();
+         window = speech_stream.next_window(CHUNK_SIZE)) {
+        // Every window owns its float samples, as the PCM stream reuses the window memory
+        std::vector<f32> samples;
+        pcm_to_f32(window, samples);
+
+        auto const source_offset = speech_stream.source_position(offset);
+        in_flight.push_back(window_pool.submit(
+                [&pool, tenant, params, adaptive_audio_ctx, source_offset,
+                 samples = std::move(samples)]() -> Result<TranscribedWindow> {
+                    TranscribedWindow transcribed{ .segments = {}, .compute_seconds = 0.0 };
+                    auto window_params = params;
+                    window_params.new_segment_callback = collect_segment;
+                    window_params.new_segment_callback_user_data = &transcribed.segments;
+
+                    auto const whisper = acquire_window(pool, tenant, samples.size(), adaptive_audio_ctx);
+                    if (adaptive_audio_ctx) {
+                        window_params.audio_ctx = fit_audio_ctx(whisper.context(), samples.size());
+                    }
+                    auto const window_started = std::chrono::steady_clock::now();
+                    auto const failed = whisper_full_with_state(whisper.context(), whisper.state(), window_params,
+                                                                samples.data(),
+                                                                static_cast<int>(samples.size())) != 0;
+                    transcribed.compute_seconds =
+                            std::chrono::duration<f64>(std::chrono::steady_clock::now() - window_started).count();
+                    if (failed) {
+                        spdlog::error("Failed to transcribe chunk at offset {} ({} samples)", source_offset,
+                                      samples.size());
+                        return tl::unexpected("Failed to transcribe audio chunk");
+                    }
+
+                    spdlog::debug("Transcribed chunk at offset {} ({} samples)", source_offset, samples.size());
+                    return transcribed;
+                }));
+        offset += window.size();
+
+        // Write every window whose predecessors are written, wait if too many windows are in flight
+        while (front_ready() or in_flight.size() >= max_windows) {
+            if (auto const written = write_front(); not written) {
+                return fail(written.error());
+            }
+        }
+    }
+
+    while (not in_flight.empty()) {
+        if (auto const written = write_front(); not written) {
+            return fail(written.error());
+        }
+    }
+    return Transcribed{ .samples = offset, .compute_seconds = compute_seconds };
 }
 
 }// anonymous namespace
 
 TranscriberService::TranscriberService(std::filesystem::path const &model_path,
-                                       std::shared_ptr<persistence::Persistence::Stub> stub)
-    : m_context{ nullptr },
-      m_persistence_stub{ std::move(stub) } {
-
-    // Load the whisper model from the specified model path with default params
-    auto *context = whisper_init_from_file_with_params(model_path.string().c_str(), whisper_context_default_params());
-    if (not context) {
-        spdlog::error("Failed to initialize whisper context, shutting down.");
+                                       std::shared_ptr<PersistenceSessions> persistence,
+                                       TranscriberOptions options)
+    : m_models{ model_path, options.whisper_states, options.model_memory_budget },
+      m_persistence{ std::move(persistence) },
+      m_options{ options },
+      m_transcript_settings{ transcript_settings(options) },
+      m_admission{ options.request_threads, options.queued_requests },
+      m_request_pool{ m_admission.capacity() } {
+
+    // The default model is loaded upfront, other models are loaded once they are requested
+    if (auto const model = m_models.acquire(m_models.default_model()); not model) {
+        spdlog::error("{} Shutting down.", model.error());
         std::exit(1);
     }
 
-    // Initialize our context structure which is a ReadWriteLock to guarantee thread safety
-    m_context = std::make_unique<utils::ReadWriteLock<WhisperContext>>(context, whisper_free);
+    // The decode pool is shared by all requests, so segmented decoding never exceeds the configured threads
+    if (m_options.decode_threads > 1) {
+        m_decode_pool = std::make_unique<utils::ThreadPool>(m_options.decode_threads);
+    }
+
+    // Concurrent windows of all requests share one thread per whisper state, as only that many can run at once
+    if (m_options.parallel_windows > 1) {
+        m_window_pool = std::make_unique<utils::ThreadPool>(std::max<usize>(m_options.whisper_states, 1));
+    }
+
+    if (not m_options.transcript_cache_directory.empty()) {
+        m_transcript_cache = std::make_unique<TranscriptCache>(m_options.transcript_cache_directory,
+                                                               m_options.transcript_cache_capacity);
+    }
+
+    if (not m_options.pcm_cache_directory.empty()) {
+        m_pcm_cache = std::make_unique<PcmCache>(m_options.pcm_cache_directory, m_options.pcm_cache_capacity);
+    }
+
+    if (m_options.fingerprint_capacity > 0) {
+        m_fingerprints = std::make_unique<FingerprintIndex>(m_options.fingerprint_capacity,
+                                                            m_options.fingerprint_max_bit_error_rate);
+    }
 }
 
-grpc::Status TranscriberService::transcribe(
-        grpc::ServerContext *context,
-        grpc::ServerReaderWriter<transcriber::Transcript, transcriber::Chunk> *stream) {
+grpc::ServerBidiReactor<transcriber::Chunk, transcriber::Transcript> *TranscriberService::transcribe(
+        grpc::CallbackServerContext *context) {
     spdlog::info("Incoming transcribe request");
 
-    // Initialize the client context required to perform calls to the gRPC persistence service
-    grpc::ClientContext persist_context;
-    google::protobuf::Empty persist_response;
+    // The reactor stays alive until it is finished, which is the last thing the request pool does with it
+    auto *stream = new Stream;
+
+    // A full queue rejects the request before any of its upload is received
+    auto ticket = m_admission.enter();
+    if (not ticket) {
+        auto const retry_after = m_admission.retry_after();
+        spdlog::warn("Rejecting transcribe request, {} transcriptions are active and {} queued", m_admission.active(),
+                     m_admission.queued());
+        context->AddTrailingMetadata("retry-after", std::to_string(retry_after.count()));
+        stream->Finish(grpc::Status{ grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                     std::format("Transcriber is at capacity, retry in {} s", retry_after.count()) });
+        return stream;
+    }
 
-    // Initialize the client writer required to perform calls to the gRPC persistence service
-    auto persist_writer = m_persistence_stub->persistTranscript(&persist_context, &persist_response);
+    // The request pool has a thread for every place in the queue, so the request starts waiting right away
+    m_request_pool.submit([this, context, stream, ticket = std::move(*ticket)]() mutable {
+        stream->Finish(transcribe(context, stream, std::move(ticket)));
+    });
+    return stream;
+}
 
-    // This continuation makes sure that the writer is properly dealt with, no matter what happens via RAII
-    auto persist_finish = utils::Continuation{ [&persist_writer] {
-        if (not persist_writer) {
-            return;
+grpc::Status TranscriberService::transcribe(grpc::CallbackServerContext *context,
+                                            Stream *stream,
+                                            AdmissionQueue::Ticket ticket) {
+    // Only the first chunk is read before the request is admitted, as it tells the user and thereby its turn
+    transcriber::Chunk first;
+    if (not stream->Read(&first)) {
+        spdlog::warn("Transcribe request ended before its first chunk");
+        return grpc::Status{ grpc::StatusCode::INVALID_ARGUMENT, "Expected at least one chunk" };
+    }
+    auto const user_weight = m_options.user_weights.find(first.userid());
+    Tenant const tenant{ .user = first.userid(),
+                         .weight = user_weight != m_options.user_weights.end() ? user_weight->second : 1.0 };
+
+    // Requests that cannot finish before their deadline are rejected before their upload is received, if the caller
+    // tells the duration of its media. The time in the queue counts towards the deadline as well.
+    auto const deadline = context->deadline();
+    if (first.duration() > 0.0 and deadline != std::chrono::system_clock::time_point::max()) {
+        auto const model = first.model().empty() ? m_models.default_model() : first.model();
+        auto const profile =
+                transcriber::Profile_IsValid(first.profile()) ? first.profile() : transcriber::PROFILE_BALANCED;
+        if (auto const estimate = estimate_seconds(model, profile, first.duration())) {
+            auto const wait = ticket.expected_wait();
+            auto const remaining = std::chrono::duration<f64>(deadline - std::chrono::system_clock::now()).count();
+            if (wait + *estimate > remaining) {
+                spdlog::warn("Rejecting transcription of {:.1f}s of audio at admission, it waits about {:.1f}s and "
+                             "takes about {:.1f}s but the deadline is in {:.1f}s",
+                             first.duration(), wait, *estimate, remaining);
+                return grpc::Status{ grpc::StatusCode::DEADLINE_EXCEEDED,
+                                     std::format("Transcription takes about {:.0f}s, which exceeds the deadline",
+                                                 wait + *estimate) };
+            }
         }
+    }
 
-        persist_writer->WritesDone();
-        persist_writer->Finish();
-    } };
-
-    // Even if the persistence writer is not present, we still want to perform the transcription
-    if (not persist_writer) {
-        spdlog::error("Cannot persist transcription, unable to establish connection!");
+    // The caller learns its position in the queue while it waits, the rest of the upload is received afterwards
+    auto const admitted = ticket.wait(
+            tenant.user, tenant.weight,
+            [stream](usize const position) {
+                spdlog::debug("Transcribe request waits at position {}", position);
+                transcriber::Transcript transcript;
+                transcript.set_queueposition(static_cast<u32>(position));
+                stream->Write(transcript);
+            },
+            [context] { return context->IsCancelled(); });
+    if (not admitted) {
+        spdlog::info("Transcribe request was cancelled while it waited");
+        return grpc::Status::CANCELLED;
     }
 
-    // Prepare a chunk
-    transcriber::Chunk chunk;
-    std::ostringstream data_stream;
+    // Receive the upload. In streaming mode, decoding already starts while the upload is still arriving
+    Upload upload{ context, stream, std::move(first), m_options.streaming_decode };
 
-    // While there are incoming chunks of the media file, append them to our data stream
-    while (stream->Read(&chunk)) {
-        const auto &data = chunk.data();
-        data_stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+    // The requested model is loaded if necessary and stays loaded until the transcription is done
+    auto const whisper_pool = m_models.acquire(upload.model());
+    if (not whisper_pool) {
+        spdlog::error("Failed to load model: {}", whisper_pool.error());
+        upload.abort();
+        return grpc::Status{ grpc::StatusCode::INVALID_ARGUMENT, whisper_pool.error() };
     }
 
-    spdlog::info("Finished reading transcribe request");
+    // Profiles that this worker does not know yet fall back to the balanced profile
+    auto const profile =
+            transcriber::Profile_IsValid(upload.profile()) ? upload.profile() : transcriber::PROFILE_BALANCED;
+
+    // Initialize the TranscribeContext to pass it to whisper
+    // The transcription ID is necessary to correlate it later on to a summary -> together they form a smart session
+    // The writer completes the persistence stream once it goes out of scope, no matter how the request ends
+    auto const transcription_id = utils::UUID::generate_v4();
+    SegmentWriter writer{ stream, m_persistence.get(), transcription_id, upload.user_id(), profile,
+                          m_options.segment_writer, m_segment_metrics };
+    std::vector<std::string> segments;
+    TranscribeContext transcribe_context{ .writer = &writer,
+                                          .segments = m_transcript_cache or m_fingerprints ? &segments : nullptr };
+
+    // The transcript depends on the upload, the model, the profile and the options of the worker. Buffered uploads
+    // are complete at this point, so a repeated upload is answered from the cache. Streaming uploads are only
+    // hashed once received.
+    auto const model = upload.model().empty() ? m_models.default_model() : upload.model();
+    auto const transcript_key = [&](UploadDigest const &received) {
+        return TranscriptCache::key(received, model, profile, m_transcript_settings);
+    };
+    auto const digest = upload.digest();
+    if (m_transcript_cache and digest) {
+        if (auto const cached = m_transcript_cache->lookup(transcript_key(*digest))) {
+            spdlog::info("Answering transcribe request from cache ({} segments)", cached->size());
+            replay_segments(transcribe_context, *cached);
+            spdlog::info("Transcribe OK.");
+            return grpc::Status::OK;
+        }
+    }
 
-    // Convert our data stream to a full string
-    auto const input_video = data_stream.str();
+    // An upload that was decoded before is mapped from the PCM cache instead of being decoded again
+    auto cached_pcm =
+            m_pcm_cache and digest ? m_pcm_cache->open(PcmCache::key(*digest, m_options.decode)) : std::nullopt;
+    auto const pcm_cached = cached_pcm.has_value();
+    if (pcm_cached) {
+        spdlog::info("Reading decoded PCM from cache");
+    }
 
-    // This performs the actual conversion of the input media file to raw PCM32 samples
-    auto const decoded = decode_pcm32({ input_video.begin(), input_video.end() });
+    // The PCM stream converts the input media file to raw 16 bit PCM samples, one window at a time
+    // If configured, buffered uploads are decoded upfront in parallel segments instead
+    auto const source_factory = upload.source_factory();
+    auto pcm_stream = pcm_cached ? Result<PcmStream>{ std::move(*cached_pcm) }
+                      : m_decode_pool and source_factory
+                              ? PcmStream::open_segmented(source_factory, *m_decode_pool, m_decode_pool->size(),
+                                                          m_options.decode)
+                              : PcmStream::open(upload.source(), m_options.decode);
 
     // If the decoding failed, return an error to the caller
-    if (not decoded) {
-        spdlog::error("Failed to decode pcm32 from input: {}", decoded.error());
+    if (not pcm_stream) {
+        spdlog::error("Failed to decode pcm32 from input: {}", pcm_stream.error());
+        upload.abort();
         return grpc::Status{ grpc::StatusCode::UNAVAILABLE,
-                             std::format("Failed to decode PCM32: {}", decoded.error()) };
+                             std::format("Failed to decode PCM32: {}", pcm_stream.error()) };
     }
 
-    // If there are no samples, return an error to the caller
-    if (decoded->empty()) {
-        spdlog::warn("PCM32 samples are empty");
-        return grpc::Status{ grpc::StatusCode::UNAVAILABLE, "Failed to retrieve PCM32 samples" };
+    // Freshly decoded PCM is spilled to disk while it is transcribed, it is only kept if the whole upload is
+    // transcribed
+    std::unique_ptr<PcmSpill> pcm_spill;
+    if (m_pcm_cache and not pcm_cached) {
+        pcm_spill = m_pcm_cache->spill();
     }
 
-    spdlog::info("Decoded {} PCM samples", decoded->size());
+    // The fingerprint of the audio is computed from the same windows. Transcripts are only reused for the audio
+    // of the same user, audio without a user is not fingerprinted.
+    auto const fingerprinting = m_fingerprints and not upload.user_id().empty();
+    Fingerprinter fingerprinter;
+    if (pcm_spill or fingerprinting) {
+        pcm_stream->observe([&pcm_spill, &fingerprinter, fingerprinting](std::span<s16 const> const window) {
+            if (pcm_spill) {
+                pcm_spill->write(window);
+            }
+            if (fingerprinting) {
+                fingerprinter.feed(window);
+            }
+        });
+    }
 
-    // Initialize the TranscribeContext to pass it to whisper
-    // The transcription ID is necessary to correlate it later on to a summary -> together they form a smart session
-    auto const transcription_id = utils::UUID::generate_v4();
-    TranscribeContext transcribe_context{ .transcription_id = transcription_id,
-                                          .user_id = chunk.userid(),
-                                          .stream = stream,
-                                          .persistence_writer = persist_writer.get() };
-
-    // Initialize whisper with the default parameters and the callback function to handle new segments
-    // Beam search performs better than greedy search
-    auto params = whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH);
+    // Buffered uploads look up the transcript of the same audio in another encoding. The fingerprint of their start,
+    // which is decoded ahead and transcribed afterwards, tells whether there may be one. Only then the whole audio
+    // is decoded once more and the match is verified on its fingerprint, which also does not trust the length the
+    // container reports.
+    auto const settings = std::format("{}-{}-{}", model, static_cast<int>(profile), m_transcript_settings);
+    if (fingerprinting and digest and source_factory) {
+        Fingerprinter prefix_fingerprinter;
+        prefix_fingerprinter.feed(pcm_stream->peek(FINGERPRINT_PREFIX_SIZE));
+        if (m_fingerprints->has_candidate(prefix_fingerprinter.finish(), upload.user_id(), settings)) {
+            auto const fingerprint = fingerprint_media(source_factory, m_options.decode);
+            auto const match = fingerprint ? m_fingerprints->find(*fingerprint, upload.user_id(), settings)
+                                           : std::nullopt;
+            if (match) {
+                // The transcript is only nearly of the same audio, hence it is not cached for the digest of this upload
+                spdlog::info("Answering transcribe request with the transcript of the same audio ({} segments, "
+                             "bit error rate {:.3f})",
+                             match->segments.size(), match->bit_error_rate);
+                replay_segments(transcribe_context, match->segments);
+                spdlog::info("Transcribe OK.");
+                return grpc::Status::OK;
+            }
+        }
+    }
+
+    // Initialize whisper with the parameters of the profile and the callback function to handle new segments
+    // The cores are divided between the states that may run concurrently
+    auto const hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    auto params = profile_params(profile, std::max<usize>(hardware_threads / (*whisper_pool)->size(), 1));
     params.new_segment_callback_user_data = &transcribe_context;
     params.new_segment_callback = handle_segment;
 
@@ -193,29 +696,132 @@ grpc::Status TranscriberService::transcribe(
     params.language = nullptr;
     params.translate = false;
 
-    // Split the decoded PCM samples into chunks to avoid overloading whisper
-    for (size_t i = 0; i < decoded->size(); i += CHUNK_SIZE) {
-        auto const len = std::min(static_cast<size_t>(CHUNK_SIZE), decoded->size() - i);
-
-        // Lock the context as now we want to perform the actual transcription
-        auto context_lock = m_context->lock();
+    // Whisper stops as soon as the request is cancelled, which includes that its deadline passed
+    params.abort_callback = abort_cancelled;
+    params.abort_callback_user_data = context;
+
+    // Requests that cannot finish before their deadline are rejected before whisper spends any time on them.
+    // Once decoding started the duration is known, even if the caller did not tell it at admission.
+    auto const realtime_key = RealtimeModel::key(model, profile, static_cast<usize>(params.n_threads));
+    auto const estimate = pcm_stream->duration() > 0.0
+                                  ? estimate_seconds(model, profile, pcm_stream->duration())
+                                  : std::nullopt;
+    if (estimate and deadline != std::chrono::system_clock::time_point::max()) {
+        auto const remaining = std::chrono::duration<f64>(deadline - std::chrono::system_clock::now()).count();
+        if (*estimate > remaining) {
+            spdlog::warn("Rejecting transcription of {:.1f}s of audio, it takes about {:.1f}s but the deadline is in "
+                         "{:.1f}s",
+                         pcm_stream->duration(), *estimate, remaining);
+            upload.abort();
+            return grpc::Status{ grpc::StatusCode::DEADLINE_EXCEEDED,
+                                 std::format("Transcription takes about {:.0f}s, which exceeds the deadline",
+                                             *estimate) };
+        }
+    }
 
-        // This performs the actual transcription
-        if (whisper_full(context_lock->get(), params, decoded->data() + i, static_cast<int>(len)) != 0) {
-            spdlog::error("Failed to transcribe chunk at offset {} ({} samples)", i, len);
-            return grpc::Status{ grpc::StatusCode::UNAVAILABLE, "Failed to transcribe audio chunk" };
+    auto const started = std::chrono::steady_clock::now();
+
+    // If configured, silence and other non-speech is dropped before it reaches whisper
+    // The windows end in pauses close to the 30 second limit, rather than in the middle of a word
+    SpeechStream speech_stream{ *pcm_stream, m_options.voice_detector ? m_options.voice_detector() : nullptr,
+                                m_options.boundary_tolerance_ms * SAMPLE_RATE / 1000 };
+
+    // Long uploads are transcribed in concurrent windows if configured, otherwise one window at a time
+    auto const transcribed =
+            m_window_pool ? transcribe_parallel(speech_stream, **whisper_pool, tenant, *m_window_pool,
+                                                m_options.parallel_windows, params, m_options.adaptive_audio_ctx,
+                                                transcribe_context)
+                          : transcribe_sequential(speech_stream, **whisper_pool, tenant, params,
+                                                  m_options.adaptive_audio_ctx, m_options.carry_context);
+    if (not transcribed) {
+        if (context->IsCancelled()) {
+            spdlog::info("Stopped transcription, the request was cancelled");
+            return grpc::Status::CANCELLED;
         }
+        return grpc::Status{ grpc::StatusCode::UNAVAILABLE, transcribed.error() };
+    }
 
-        spdlog::debug("Transcribed chunk {} ({} samples)", i / CHUNK_SIZE, len);
+    // If there are no samples, return an error to the caller
+    if (speech_stream.total_samples() == 0) {
+        spdlog::warn("PCM32 samples are empty");
+        return grpc::Status{ grpc::StatusCode::UNAVAILABLE, "Failed to retrieve PCM32 samples" };
+    }
+
+    // The realtime factor is the processing time relative to the duration of the audio
+    auto const elapsed = std::chrono::duration<f64>(std::chrono::steady_clock::now() - started).count();
+    auto const duration = static_cast<f64>(speech_stream.total_samples()) / SAMPLE_RATE;
+    spdlog::info("Decoded {} PCM samples", speech_stream.total_samples());
+    spdlog::info("Transcribed {:.1f}s of audio with profile {} at a realtime factor of {:.3f} ({:.3f} in whisper)",
+                 duration, transcriber::Profile_Name(profile), elapsed / duration,
+                 transcribed->compute_seconds / duration);
+    if (m_options.voice_detector) {
+        auto const skipped = speech_stream.total_samples() - speech_stream.speech_samples();
+        spdlog::info("Skipped {:.1f}s of {:.1f}s as non-speech", static_cast<f64>(skipped) / SAMPLE_RATE,
+                     static_cast<f64>(speech_stream.total_samples()) / SAMPLE_RATE);
     }
 
+    // The time whisper spent predicts the duration of later requests with the same configuration
+    if (not context->IsCancelled()) {
+        m_realtime.observe(realtime_key, duration, transcribed->compute_seconds);
+    }
+
+    // Only complete transcripts and PCM are cached, i.e. neither cancelled requests nor partially received uploads
+    if (auto const received = upload.digest(); received and not context->IsCancelled()) {
+        if (m_transcript_cache) {
+            m_transcript_cache->store(transcript_key(*received), segments);
+        }
+        if (pcm_spill) {
+            pcm_spill->commit(PcmCache::key(*received, m_options.decode));
+        }
+        if (fingerprinting) {
+            m_fingerprints->insert(fingerprinter.finish(), upload.user_id(), settings, segments);
+        }
+    }
     spdlog::info("Transcribe OK.");
     return grpc::Status::OK;
 }
 
-grpc::Status TranscriberService::heartbeat(grpc::ServerContext *context,
-                                           google::protobuf::Empty const *,
-                                           google::protobuf::Empty *) {
+std::optional<f64> TranscriberService::estimate_seconds(std::string const &model,
+                                                        transcriber::Profile const profile,
+                                                        f64 const duration) const {
+    // The threads of a state depend on the profile, just as when the transcription runs
+    auto const states = std::max<usize>(m_options.whisper_states, 1);
+    auto const hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    auto const threads = profile_params(profile, std::max<usize>(hardware_threads / states, 1)).n_threads;
+    auto const realtime_factor = m_realtime.factor(RealtimeModel::key(model, profile, static_cast<usize>(threads)));
+    if (not realtime_factor) {
+        return std::nullopt;
+    }
+
+    auto const windows = m_window_pool ? static_cast<f64>(m_options.parallel_windows) : 1.0;
+    auto const share = std::min(static_cast<f64>(states) / static_cast<f64>(std::max<usize>(m_admission.active(), 1)),
+                                windows);
+    return duration * *realtime_factor / share;
+}
+
+grpc::ServerUnaryReactor *TranscriberService::heartbeat(grpc::CallbackServerContext *context,
+                                                        google::protobuf::Empty const *,
+                                                        google::protobuf::Empty *) {
     spdlog::info("Incoming transcriber heartbeat, respond with OK");
-    return grpc::Status::OK;
+    if (m_transcript_cache) {
+        auto const stats = m_transcript_cache->stats();
+        spdlog::info("Transcript cache: {} hits, {} misses, {} stores, {} evictions", stats.hits, stats.misses,
+                     stats.stores, stats.evictions);
+    }
+    if (m_pcm_cache) {
+        auto const stats = m_pcm_cache->stats();
+        spdlog::info("PCM cache: {} hits, {} misses, {} stores, {} evictions", stats.hits, stats.misses,
+                     stats.stores, stats.evictions);
+    }
+    if (m_fingerprints) {
+        spdlog::info("Fingerprint index: {} transcripts", m_fingerprints->size());
+    }
+    spdlog::info("Transcriptions: {} active, {} queued", m_admission.active(), m_admission.queued());
+    spdlog::info("Segment writers: {} queued (peak {}), {} segments in {} persistence chunks, {} stalls",
+                 m_segment_metrics.queued.load(), m_segment_metrics.peak_queued.load(),
+                 m_segment_metrics.segments.load(), m_segment_metrics.chunks.load(),
+                 m_segment_metrics.stalls.load());
+    auto *reactor = context->DefaultReactor();
+    reactor->Finish(grpc::Status::OK);
+    return reactor;
 }
@@ -24,53 +24,185 @@
 #ifndef TRANSCRIBER_H
 #define TRANSCRIBER_H
 
-#include "utils/lock.h"
+#include "admission.h"
+#include "blocking_reactor.h"
+#include "decode.h"
+#include "fingerprint.h"
+#include "model_registry.h"
+#include "pcm_cache.h"
+#include "persistence_sessions.h"
+#include "realtime_model.h"
+#include "segment_writer.h"
+#include "transcript_cache.h"
+#include "types.h"
+#include "utils/thread_pool.h"
+#include "vad.h"
 
 #include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 #include <persistence.grpc.pb.h>
 #include <transcriber.grpc.pb.h>
 
-#include <whisper.h>
+/**
+ * Configuration of the TranscriberService
+ */
+struct TranscriberOptions {
+    // Decode the upload while it is still arriving instead of buffering it completely.
+    // This requires a streamable container, as the decoder cannot seek in the upload.
+    bool streaming_decode = false;
+
+    // The amount of threads used to decode one upload in parallel segments. Segmented decoding
+    // holds the PCM of the whole upload in memory and is not available in streaming mode.
+    usize decode_threads = 1;
+
+    // Options for demuxing and decoding the uploads
+    DecodeOptions decode;
+
+    // The amount of whisper states per model, i.e. how many transcriptions of a model run
+    // concurrently. The model weights are shared, but every state holds its own buffers.
+    usize whisper_states = 1;
+
+    // The memory in bytes that the loaded models may occupy before idle models are evicted, 0 for no limit
+    usize model_memory_budget = 0;
+
+    // The maximum amount of 30 second windows of one request that are transcribed concurrently.
+    // The segments are still written in chronological order.
+    usize parallel_windows = 1;
+
+    // Creates the voice detector of a request. If set, non-speech is dropped before transcription.
+    VoiceDetectorFactory voice_detector;
+
+    // Windows end at the quietest point within this many milliseconds before the 30 second
+    // limit, so words are not split across windows. 0 cuts the windows at exactly 30 seconds.
+    usize boundary_tolerance_ms = 2000;
+
+    // Size the encoder context of whisper to the length of short windows instead of always
+    // encoding 30 seconds. Short uploads and final windows then cost proportionally less.
+    bool adaptive_audio_ctx = false;
+
+    // Detect the language once per request and prompt every window with the tokens of the
+    // previous window. Only applies to sequential transcription, as concurrent windows are
+    // transcribed independently of each other.
+    bool carry_context = true;
+
+    // The directory in which the transcripts of finished requests are cached by the content of
+    // their upload, so repeated uploads are answered without transcribing them. Empty disables the cache.
+    std::filesystem::path transcript_cache_directory;
+
+    // The size in bytes that the cached transcripts may occupy
+    usize transcript_cache_capacity = 1024 * 1024 * 1024;
+
+    // The directory in which the decoded PCM of uploads is cached by their content, so transcribing
+    // an upload again with another model or profile skips decoding. Empty disables the cache.
+    std::filesystem::path pcm_cache_directory;
+
+    // The size in bytes that the cached PCM may occupy, one hour of audio takes about 110 MiB
+    usize pcm_cache_capacity = 4ull * 1024 * 1024 * 1024;
+
+    // The amount of recent transcripts whose acoustic fingerprint is kept in memory, so the same audio
+    // of the same user in another encoding reuses the transcript. 0 disables fingerprinting. Every hour
+    // of audio takes about 220 KiB of fingerprint.
+    usize fingerprint_capacity = 0;
+
+    // The maximum share of differing fingerprint bits of the same audio, in every part of it
+    f64 fingerprint_max_bit_error_rate = 0.25;
+
+    // How the segments are queued and coalesced on their way to the caller and to persistence
+    SegmentWriterOptions segment_writer;
+
+    // The amount of transcriptions that run at once, each on a thread of its own. Further requests
+    // wait for their turn before their upload is received.
+    usize request_threads = 4;
+
+    // The amount of requests that wait for their turn, further requests are rejected with
+    // RESOURCE_EXHAUSTED and a retry-after hint in the trailing metadata
+    usize queued_requests = 16;
+
+    // The weights of users at the admission queue and the whisper states, users without weight
+    // weigh 1. A user of weight 2 gets twice the windows of a user of weight 1 while both wait.
+    std::unordered_map<std::string, f64> user_weights;
+};
 
 /**
  * The TranscriberService defines a gRPC service in order for the
- * other services to perform transcription.
+ * other services to perform transcription. Transcriptions run on a
+ * request pool, they never occupy the threads of the gRPC server.
  */
-struct TranscriberService final : transcriber::Transcriber::Service {
+struct TranscriberService final : transcriber::Transcriber::CallbackService {
     /**
      * Instantiates a new transcriber service
-     * @param model_path The path to the whisper model
-     * @param stub The stub for persistence
+     * @param model_path The path to the default whisper model, other models are loaded from its directory
+     * @param persistence The sessions to the persistence service
+     * @param options The transcriber configuration
      */
     explicit TranscriberService(std::filesystem::path const &model_path,
-                                std::shared_ptr<persistence::Persistence::Stub> stub);
+                                std::shared_ptr<PersistenceSessions> persistence,
+                                TranscriberOptions options = {});
 
     /**
-     * Transcribes a given video
+     * Transcribes a given video on the request pool
      * @param context The server context
-     * @param stream Used for accessing the data
-     * @return A grpc status
+     * @return The reactor of the call
      */
-    grpc::Status transcribe(grpc::ServerContext *context,
-                            grpc::ServerReaderWriter<transcriber::Transcript, transcriber::Chunk> *stream) override;
+    grpc::ServerBidiReactor<transcriber::Chunk, transcriber::Transcript> *transcribe(
+            grpc::CallbackServerContext *context) override;
 
     /**
      * Endpoint for checking whether the transcriber service is running
      * @param context The server context
      * @param request The heartbeat request, which is empty
      * @param response The response, which is empty
-     * @return A grpc status
+     * @return The reactor of the call
      */
-    grpc::Status heartbeat(grpc::ServerContext *context,
-                           const google::protobuf::Empty *request,
-                           google::protobuf::Empty *response) override;
+    grpc::ServerUnaryReactor *heartbeat(grpc::CallbackServerContext *context,
+                                        const google::protobuf::Empty *request,
+                                        google::protobuf::Empty *response) override;
 
 private:
-    using WhisperContext = std::unique_ptr<whisper_context, decltype((whisper_free))>;
-    std::unique_ptr<utils::ReadWriteLock<WhisperContext>> m_context;
-    std::shared_ptr<persistence::Persistence::Stub> m_persistence_stub;
+    using Stream = BlockingBidiReactor<transcriber::Chunk, transcriber::Transcript>;
+
+    /**
+     * Transcribes a given video once it is admitted, runs on a thread of the request pool
+     * @param context The server context
+     * @param stream Used for accessing the data
+     * @param ticket The place of the request in the admission queue
+     * @return A grpc status
+     */
+    grpc::Status transcribe(grpc::CallbackServerContext *context, Stream *stream, AdmissionQueue::Ticket ticket);
+
+    /**
+     * Estimates how long whisper takes for an audio, from the learned realtime factor of its configuration.
+     * The active transcriptions share the whisper states, a request uses as many as it has windows in flight.
+     * @param model The name of the model
+     * @param profile The profile of the transcription
+     * @param duration The duration of the audio in seconds
+     * @return The estimate in seconds, or nothing if the realtime factor is not learned yet
+     */
+    [[nodiscard]] std::optional<f64> estimate_seconds(std::string const &model,
+                                                      transcriber::Profile profile,
+                                                      f64 duration) const;
+
+    ModelRegistry m_models;
+    std::shared_ptr<PersistenceSessions> m_persistence;
+    TranscriberOptions m_options;
+
+    // The digest of the options that affect the transcript, part of the keys of cached transcripts
+    std::string m_transcript_settings;
+    std::unique_ptr<utils::ThreadPool> m_decode_pool;
+    std::unique_ptr<utils::ThreadPool> m_window_pool;
+    std::unique_ptr<TranscriptCache> m_transcript_cache;
+    std::unique_ptr<PcmCache> m_pcm_cache;
+    std::unique_ptr<FingerprintIndex> m_fingerprints;
+    SegmentWriterMetrics m_segment_metrics;
+    AdmissionQueue m_admission;
+    RealtimeModel m_realtime;
+
+    // Declared last, so the running transcriptions are completed before anything they use is destroyed
+    utils::ThreadPool m_request_pool;
 };
 
 #endif// TRANSCRIBER_H
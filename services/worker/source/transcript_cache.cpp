@@ -0,0 +1,140 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "transcript_cache.h"
+
+#include <format>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Cached transcripts are stored in files with this extension
+constexpr auto TRANSCRIPT_EXTENSION = ".transcript";
+
+/**
+ * Reads a transcript file, which consists of the amount of segments followed by every segment prefixed with its length
+ * @param path The path of the file
+ * @return The segments, or nothing if the file is missing or malformed
+ */
+std::optional<std::vector<std::string>> read_transcript(std::filesystem::path const &path) {
+    std::ifstream file{ path, std::ios::binary };
+    std::error_code error;
+    auto remaining = std::filesystem::file_size(path, error);
+    if (not file or error) {
+        return std::nullopt;
+    }
+
+    // The counts are checked against the rest of the file before anything is allocated for them,
+    // a truncated or damaged file must not be able to request arbitrary amounts of memory
+    auto const read_u64 = [&file, &remaining](u64 &value) {
+        if (remaining < sizeof(value) or not file.read(reinterpret_cast<char *>(&value), sizeof(value))) {
+            return false;
+        }
+        remaining -= sizeof(value);
+        return true;
+    };
+
+    u64 count = 0;
+    if (not read_u64(count) or count > remaining / sizeof(u64)) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> segments;
+    segments.reserve(count);
+    for (u64 i = 0; i < count; ++i) {
+        u64 length = 0;
+        if (not read_u64(length) or length > remaining) {
+            return std::nullopt;
+        }
+        remaining -= length;
+
+        std::string segment(length, '\0');
+        if (not file.read(segment.data(), static_cast<std::streamsize>(length))) {
+            return std::nullopt;
+        }
+        segments.push_back(std::move(segment));
+    }
+    return segments;
+}
+
+/**
+ * Writes a transcript file
+ * @param path The path of the file
+ * @param segments The segments of the transcript
+ * @return Whether the file was written completely
+ */
+bool write_transcript(std::filesystem::path const &path, std::vector<std::string> const &segments) {
+    std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+    u64 const count = segments.size();
+    file.write(reinterpret_cast<char const *>(&count), sizeof(count));
+    for (auto const &segment: segments) {
+        u64 const length = segment.size();
+        file.write(reinterpret_cast<char const *>(&length), sizeof(length));
+        file.write(segment.data(), static_cast<std::streamsize>(length));
+    }
+    return static_cast<bool>(file.flush());
+}
+
+}// anonymous namespace
+
+TranscriptCache::TranscriptCache(std::filesystem::path directory, usize const capacity)
+    : m_files{ std::move(directory), TRANSCRIPT_EXTENSION, capacity } {
+    spdlog::info("Transcript cache holds {} transcripts ({} bytes)", m_files.count(), m_files.size());
+}
+
+std::string TranscriptCache::key(UploadDigest const &digest,
+                                 std::string const &model,
+                                 transcriber::Profile const profile,
+                                 std::string const &settings) {
+    return std::format("{:016x}-{}-{}-{}-{}", digest.hash, digest.size, model, static_cast<int>(profile), settings);
+}
+
+std::optional<std::vector<std::string>> TranscriptCache::lookup(std::string const &key) {
+    auto const path = m_files.find(key);
+    if (not path) {
+        return std::nullopt;
+    }
+
+    auto segments = read_transcript(*path);
+    if (not segments) {
+        // The file was evicted concurrently or damaged outside of the cache
+        spdlog::warn("Dropping unreadable cached transcript {}", key);
+        m_files.discard(key);
+    }
+    return segments;
+}
+
+void TranscriptCache::store(std::string const &key, std::vector<std::string> const &segments) {
+    auto const temporary = m_files.temporary(key);
+    if (not write_transcript(temporary, segments) or not m_files.insert(key, temporary)) {
+        std::error_code error;
+        std::filesystem::remove(temporary, error);
+        spdlog::warn("Could not store transcript {} in cache", key);
+    }
+}
+
+utils::FileCacheStats TranscriptCache::stats() const {
+    return m_files.stats();
+}
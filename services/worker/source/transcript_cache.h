@@ -0,0 +1,90 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef TRANSCRIPT_CACHE_H
+#define TRANSCRIPT_CACHE_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <transcriber.grpc.pb.h>
+
+#include "types.h"
+#include "upload.h"
+#include "utils/file_cache.h"
+
+/**
+ * The TranscriptCache stores the transcripts of finished requests on disk, addressed by the
+ * content of the upload and the settings that affect the transcript. A repeated upload is answered
+ * from the cache without decoding or running whisper. Once the cache exceeds its capacity,
+ * the least recently used transcripts are deleted.
+ */
+class TranscriptCache {
+public:
+    /**
+     * Instantiates a new transcript cache, the transcripts that are already in the directory are reused
+     * @param directory The directory of the cache, it is created if it does not exist
+     * @param capacity The size in bytes that the cached transcripts may occupy
+     */
+    TranscriptCache(std::filesystem::path directory, usize capacity);
+
+    /**
+     * Computes the key of a transcript, which is safe to use as a file name
+     * @param digest The digest of the upload
+     * @param model The name of the model
+     * @param profile The profile of the request
+     * @param settings The digest of the other options that affect the transcript
+     * @return The key of the transcript
+     */
+    [[nodiscard]] static std::string key(UploadDigest const &digest,
+                                         std::string const &model,
+                                         transcriber::Profile profile,
+                                         std::string const &settings);
+
+    /**
+     * Looks up a transcript
+     * @param key The key of the transcript
+     * @return The segments of the transcript, or nothing if it is not cached
+     */
+    [[nodiscard]] std::optional<std::vector<std::string>> lookup(std::string const &key);
+
+    /**
+     * Stores a transcript, a transcript that is already cached is replaced
+     * @param key The key of the transcript
+     * @param segments The segments of the transcript
+     */
+    void store(std::string const &key, std::vector<std::string> const &segments);
+
+    /**
+     * The counters of the cache since it was instantiated
+     * @return The counters
+     */
+    [[nodiscard]] utils::FileCacheStats stats() const;
+
+private:
+    utils::FileCache m_files;
+};
+
+#endif// TRANSCRIPT_CACHE_H
@@ -0,0 +1,137 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "upload.h"
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// The amount of not yet decoded upload bytes that are buffered in streaming mode
+constexpr auto STREAM_BUFFER_CAPACITY = 16 * 1024 * 1024;
+
+}// anonymous namespace
+
+Upload::Upload(grpc::CallbackServerContext *context,
+               Stream *stream,
+               transcriber::Chunk first,
+               bool const streaming)
+    : m_context{ context },
+      m_user_id{ first.userid() },
+      m_profile{ first.profile() },
+      m_model{ first.model() },
+      m_size{ 0 },
+      m_received{ false } {
+    // The first chunk carries the user ID, the profile and the model, which are required before any segment is written
+    auto chunk = std::move(first);
+
+    // Every chunk is hashed before it is moved into a buffer
+    auto const digest_chunk = [this](std::string const &data) {
+        m_hash.update(data.data(), data.size());
+        m_size += data.size();
+    };
+
+    if (streaming) {
+        // The receiver moves the payload of every chunk into the buffer, it blocks as long as the buffer is full
+        m_stream_buffer.emplace(STREAM_BUFFER_CAPACITY);
+        m_receiver = std::thread{ [this, stream, digest_chunk, chunk = std::move(chunk)]() mutable {
+            auto &buffer = *m_stream_buffer;
+            digest_chunk(chunk.data());
+            auto accepted = buffer.write(std::move(*chunk.mutable_data()));
+            while (accepted and stream->Read(&chunk)) {
+                digest_chunk(chunk.data());
+                accepted = buffer.write(std::move(*chunk.mutable_data()));
+            }
+
+            spdlog::info("Finished reading transcribe request");
+            m_received = accepted;
+            buffer.close();
+        } };
+        return;
+    }
+
+    // While there are incoming chunks of the media file, move their payload into our buffer without copying
+    digest_chunk(chunk.data());
+    m_buffer.append(std::move(*chunk.mutable_data()));
+    while (stream->Read(&chunk)) {
+        digest_chunk(chunk.data());
+        m_buffer.append(std::move(*chunk.mutable_data()));
+    }
+
+    spdlog::info("Finished reading transcribe request ({} bytes)", m_buffer.size());
+    m_reader.emplace(m_buffer);
+    m_received = true;
+}
+
+Upload::~Upload() {
+    // A caller that stalls would keep the receiver waiting for its next chunk, so an upload that is
+    // not received completely is cancelled. This covers every path on which the transcription fails.
+    if (m_receiver.joinable() and not m_received) {
+        abort();
+    }
+
+    if (m_stream_buffer) {
+        m_stream_buffer->cancel();
+    }
+
+    if (m_receiver.joinable()) {
+        m_receiver.join();
+    }
+}
+
+MediaSource &Upload::source() {
+    if (m_stream_buffer) {
+        return *m_stream_buffer;
+    }
+    return *m_reader;
+}
+
+MediaSourceFactory Upload::source_factory() const {
+    if (m_stream_buffer) {
+        return nullptr;
+    }
+    return [this] { return std::make_unique<MediaBuffer::Reader>(m_buffer); };
+}
+
+std::string const &Upload::user_id() const {
+    return m_user_id;
+}
+
+transcriber::Profile Upload::profile() const {
+    return m_profile;
+}
+
+std::string const &Upload::model() const {
+    return m_model;
+}
+
+std::optional<UploadDigest> Upload::digest() const {
+    if (not m_received) {
+        return std::nullopt;
+    }
+    return UploadDigest{ .hash = m_hash.digest(), .size = m_size };
+}
+
+void Upload::abort() {
+    m_context->TryCancel();
+}
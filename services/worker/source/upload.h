@@ -0,0 +1,129 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <transcriber.grpc.pb.h>
+
+#include "blocking_reactor.h"
+#include "media_buffer.h"
+#include "stream_buffer.h"
+#include "utils/hash.h"
+
+/**
+ * Identifies the content of an upload
+ */
+struct UploadDigest {
+    // The XXH64 hash of the uploaded bytes
+    u64 hash;
+
+    // The size of the upload in bytes
+    usize size;
+};
+
+/**
+ * The Upload receives the media file of a transcribe request and exposes it as a MediaSource.
+ * In buffered mode, the whole upload is received before decoding starts. In streaming mode,
+ * a receiver thread feeds a bounded StreamBuffer while the decoder consumes it.
+ */
+class Upload {
+public:
+    using Stream = BlockingBidiReactor<transcriber::Chunk, transcriber::Transcript>;
+
+    /**
+     * Starts receiving the rest of the upload
+     * @param context The server context of the request
+     * @param stream The gRPC stream that provides the media chunks
+     * @param first The first chunk, which was already read from the stream by the caller
+     * @param streaming Whether the upload is decoded while it is still arriving
+     */
+    Upload(grpc::CallbackServerContext *context, Stream *stream, transcriber::Chunk first, bool streaming);
+    ~Upload();
+
+    Upload(Upload const &) = delete;
+    Upload &operator=(Upload const &) = delete;
+
+    /**
+     * The media source that provides the uploaded bytes
+     * @return The media source
+     */
+    [[nodiscard]] MediaSource &source();
+
+    /**
+     * Creates independent sources over the upload, which is only possible in buffered mode
+     * @return The source factory or nullptr if the upload is streamed
+     */
+    [[nodiscard]] MediaSourceFactory source_factory() const;
+
+    /**
+     * The ID of the user that initiated the transcription
+     * @return The user ID
+     */
+    [[nodiscard]] std::string const &user_id() const;
+
+    /**
+     * The profile that the caller requested with the first chunk
+     * @return The profile
+     */
+    [[nodiscard]] transcriber::Profile profile() const;
+
+    /**
+     * The name of the model that the caller requested with the first chunk
+     * @return The name of the model, empty for the default model
+     */
+    [[nodiscard]] std::string const &model() const;
+
+    /**
+     * The digest of the uploaded bytes, which is computed while they are received
+     * @return The digest, or nothing if the upload is not received completely yet
+     */
+    [[nodiscard]] std::optional<UploadDigest> digest() const;
+
+    /**
+     * Cancels the request, so the rest of the upload is not received anymore
+     */
+    void abort();
+
+private:
+    grpc::CallbackServerContext *m_context;
+    std::string m_user_id;
+    transcriber::Profile m_profile;
+    std::string m_model;
+    MediaBuffer m_buffer;
+    std::optional<MediaBuffer::Reader> m_reader;
+    std::optional<StreamBuffer> m_stream_buffer;
+    std::thread m_receiver;
+
+    // The digest of the bytes received so far, it is complete once received is set
+    utils::XXHash64 m_hash;
+    usize m_size;
+    std::atomic<bool> m_received;
+};
+
+#endif// UPLOAD_H
@@ -0,0 +1,130 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef UTILS_FAIR_SCHEDULER_H
+#define UTILS_FAIR_SCHEDULER_H
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace utils {
+
+/**
+ * Orders the items of several users with deficit round robin: every round, a user may take items worth its
+ * weight, so a user with many items does not crowd out the others. Items that the other users do not claim
+ * are still taken by that user. Not thread-safe.
+ * @tparam Type The type of the items
+ */
+template<typename Type>
+class FairScheduler {
+public:
+    // Weights are at least this large, so every user is served eventually
+    static constexpr double MIN_WEIGHT = 0.01;
+
+    FairScheduler() : m_visited{ false } { }
+
+    /**
+     * Appends an item of a user, after the other items of that user
+     * @param user The user the item belongs to
+     * @param weight The share of the user relative to other users, only used if the user has no items yet
+     * @param cost The cost of the item, the weight of a user pays for a cost of 1 per round
+     * @param item The item
+     */
+    void push(std::string const &user, double const weight, double const cost, Type item) {
+        auto &flow = m_flows[user];
+        if (flow.items.empty()) {
+            flow.weight = std::max(weight, MIN_WEIGHT);
+            flow.deficit = 0.0;
+            m_round.push_back(user);
+        }
+        flow.items.emplace_back(cost, std::move(item));
+    }
+
+    /**
+     * Removes the item of the user whose turn it is
+     * @return The item, or nothing if there are no items
+     */
+    std::optional<Type> pop() {
+        while (not m_round.empty()) {
+            auto &flow = m_flows.at(m_round.front());
+            if (not m_visited) {
+                flow.deficit += flow.weight;
+                m_visited = true;
+            }
+
+            // The user had its share of this round, the next user is visited
+            auto &[cost, item] = flow.items.front();
+            if (flow.deficit < cost) {
+                m_round.push_back(std::move(m_round.front()));
+                m_round.pop_front();
+                m_visited = false;
+                continue;
+            }
+
+            flow.deficit -= cost;
+            std::optional<Type> result{ std::move(item) };
+            flow.items.pop_front();
+
+            // Users without items leave the round, they do not save up a deficit
+            if (flow.items.empty()) {
+                m_flows.erase(m_round.front());
+                m_round.pop_front();
+                m_visited = false;
+            }
+            return result;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Whether there are no items
+     * @return Whether there are no items
+     */
+    [[nodiscard]] bool empty() const {
+        return m_round.empty();
+    }
+
+private:
+    /**
+     * The items of one user with their costs
+     */
+    struct Flow {
+        double weight;
+        double deficit;
+        std::deque<std::pair<double, Type>> items;
+    };
+
+    // The users with items in round robin order. The user at the front of the round
+    // receives its weight once per visit, visited tells whether it already received it.
+    std::unordered_map<std::string, Flow> m_flows;
+    std::deque<std::string> m_round;
+    bool m_visited;
+};
+
+}// namespace utils
+
+#endif// UTILS_FAIR_SCHEDULER_H
@@ -0,0 +1,176 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "file_cache.h"
+
+#include <algorithm>
+#include <format>
+#include <vector>
+
+namespace {
+
+// Temporary files of stores that are still in progress, left behind ones are deleted when the cache is opened
+constexpr std::string_view TEMPORARY_EXTENSION = ".tmp";
+
+}// anonymous namespace
+
+namespace utils {
+
+FileCache::FileCache(std::filesystem::path directory, std::string extension, std::size_t const capacity)
+    : m_directory{ std::move(directory) },
+      m_extension{ std::move(extension) },
+      m_capacity{ capacity },
+      m_size{ 0 },
+      m_temporaries{ 0 },
+      m_hits{ 0 },
+      m_misses{ 0 },
+      m_stores{ 0 },
+      m_evictions{ 0 } {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    // Rebuild the index from the files of previous runs, the most recently written files are the most recent ones
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::directory_entry>> files;
+    for (auto const &entry: std::filesystem::directory_iterator{ m_directory, error }) {
+        if (not entry.is_regular_file(error)) {
+            continue;
+        }
+
+        if (entry.path().extension() == TEMPORARY_EXTENSION) {
+            std::filesystem::remove(entry.path(), error);
+        } else if (entry.path().extension() == m_extension) {
+            files.emplace_back(entry.last_write_time(error), entry);
+        }
+    }
+    std::ranges::sort(files, std::greater{}, [](auto const &file) { return file.first; });
+
+    std::lock_guard lock{ m_mutex };
+    for (auto const &[time, entry]: files) {
+        auto const size = entry.file_size(error);
+        m_recent.push_back(entry.path().stem().string());
+        m_entries.emplace(m_recent.back(), Entry{ .size = error ? 0 : size, .recent = std::prev(m_recent.end()) });
+        m_size += error ? 0 : size;
+    }
+    evict();
+}
+
+std::optional<std::filesystem::path> FileCache::find(std::string const &key) {
+    std::lock_guard lock{ m_mutex };
+    auto const entry = m_entries.find(key);
+    if (entry == m_entries.end()) {
+        ++m_misses;
+        return std::nullopt;
+    }
+
+    m_recent.splice(m_recent.begin(), m_recent, entry->second.recent);
+    ++m_hits;
+    return path(key);
+}
+
+void FileCache::discard(std::string const &key) {
+    std::lock_guard lock{ m_mutex };
+    remove(key);
+    --m_hits;
+    ++m_misses;
+}
+
+std::filesystem::path FileCache::temporary(std::string const &key) {
+    // Concurrent stores of the same key write to different temporary files, the last one to be inserted wins
+    return m_directory / std::format("{}.{}{}", key, m_temporaries++, TEMPORARY_EXTENSION);
+}
+
+bool FileCache::insert(std::string const &key, std::filesystem::path const &temporary) {
+    std::error_code error;
+    auto const size = std::filesystem::file_size(temporary, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    std::lock_guard lock{ m_mutex };
+    std::filesystem::rename(temporary, path(key), error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    // The replaced file is gone already, only its entry is left to remove
+    if (auto const entry = m_entries.find(key); entry != m_entries.end()) {
+        m_size -= entry->second.size;
+        m_recent.erase(entry->second.recent);
+        m_entries.erase(entry);
+    }
+
+    m_recent.push_front(key);
+    m_entries.emplace(key, Entry{ .size = size, .recent = m_recent.begin() });
+    m_size += size;
+    ++m_stores;
+    evict();
+    return true;
+}
+
+FileCacheStats FileCache::stats() const {
+    return FileCacheStats{
+        .hits = m_hits,
+        .misses = m_misses,
+        .stores = m_stores,
+        .evictions = m_evictions,
+    };
+}
+
+std::size_t FileCache::count() {
+    std::lock_guard lock{ m_mutex };
+    return m_entries.size();
+}
+
+std::size_t FileCache::size() {
+    std::lock_guard lock{ m_mutex };
+    return m_size;
+}
+
+std::filesystem::path FileCache::path(std::string const &key) const {
+    return m_directory / (key + m_extension);
+}
+
+void FileCache::remove(std::string const &key) {
+    auto const entry = m_entries.find(key);
+    if (entry == m_entries.end()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(path(key), error);
+    m_size -= entry->second.size;
+    m_recent.erase(entry->second.recent);
+    m_entries.erase(entry);
+}
+
+void FileCache::evict() {
+    while (m_size > m_capacity and not m_recent.empty()) {
+        auto const key = m_recent.back();
+        remove(key);
+        ++m_evictions;
+    }
+}
+
+}// namespace utils
@@ -0,0 +1,163 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef UTILS_FILE_CACHE_H
+#define UTILS_FILE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace utils {
+
+/**
+ * The counters of a file cache
+ */
+struct FileCacheStats {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t stores;
+    std::uint64_t evictions;
+};
+
+/**
+ * A directory of files addressed by key, bounded by the total size of the files.
+ * Once the files exceed the capacity, the least recently used files are deleted.
+ * Files are written to a temporary path and moved into the cache once complete,
+ * so readers never see a partial file. The index survives restarts, as it is
+ * rebuilt from the directory.
+ */
+class FileCache {
+public:
+    /**
+     * Opens a file cache, the files that are already in the directory are reused
+     * @param directory The directory of the cache, it is created if it does not exist
+     * @param extension The extension of the cached files, e.g. ".pcm"
+     * @param capacity The size in bytes that the cached files may occupy
+     */
+    FileCache(std::filesystem::path directory, std::string extension, std::size_t capacity);
+
+    FileCache(FileCache const &) = delete;
+    FileCache &operator=(FileCache const &) = delete;
+
+    /**
+     * Looks up a file, which becomes the most recently used one. The file may be evicted
+     * at any time, hence opening it may still fail.
+     * @param key The key of the file, which must be safe to use as a file name
+     * @return The path of the file, or nothing if it is not cached
+     */
+    [[nodiscard]] std::optional<std::filesystem::path> find(std::string const &key);
+
+    /**
+     * Removes a file that was found, but turned out to be unreadable. The lookup counts as a miss.
+     * @param key The key of the file
+     */
+    void discard(std::string const &key);
+
+    /**
+     * Creates a unique temporary path for a file that is about to be stored
+     * @param key The key of the file
+     * @return The temporary path, in the directory of the cache
+     */
+    [[nodiscard]] std::filesystem::path temporary(std::string const &key);
+
+    /**
+     * Moves a completely written temporary file into the cache, a file with the same key is replaced
+     * @param key The key of the file
+     * @param temporary The temporary path of the file
+     * @return Whether the file was stored
+     */
+    bool insert(std::string const &key, std::filesystem::path const &temporary);
+
+    /**
+     * The counters of the cache since it was opened
+     * @return The counters
+     */
+    [[nodiscard]] FileCacheStats stats() const;
+
+    /**
+     * The amount of cached files
+     * @return The amount of files
+     */
+    [[nodiscard]] std::size_t count();
+
+    /**
+     * The total size of the cached files
+     * @return The size in bytes
+     */
+    [[nodiscard]] std::size_t size();
+
+private:
+    /**
+     * A cached file
+     */
+    struct Entry {
+        std::size_t size;
+        std::list<std::string>::iterator recent;
+    };
+
+    /**
+     * The path of a cached file
+     * @param key The key of the file
+     * @return The path of the file
+     */
+    [[nodiscard]] std::filesystem::path path(std::string const &key) const;
+
+    /**
+     * Removes a file from the index and deletes it, called with the lock held
+     * @param key The key of the file
+     */
+    void remove(std::string const &key);
+
+    /**
+     * Deletes the least recently used files until the cache fits into its capacity, called with the lock held
+     */
+    void evict();
+
+    std::filesystem::path m_directory;
+    std::string m_extension;
+    std::size_t m_capacity;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+
+    // The keys of the files, most recently used first
+    std::list<std::string> m_recent;
+    std::size_t m_size;
+
+    std::atomic<std::uint64_t> m_temporaries;
+    std::atomic<std::uint64_t> m_hits;
+    std::atomic<std::uint64_t> m_misses;
+    std::atomic<std::uint64_t> m_stores;
+    std::atomic<std::uint64_t> m_evictions;
+};
+
+}// namespace utils
+
+#endif// UTILS_FILE_CACHE_H
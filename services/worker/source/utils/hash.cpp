@@ -0,0 +1,145 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace utils {
+
+namespace {
+
+constexpr std::uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+std::uint64_t read64(std::uint8_t const *data) {
+    std::uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::uint32_t read32(std::uint8_t const *data) {
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+std::uint64_t round(std::uint64_t accumulator, std::uint64_t const input) {
+    accumulator += input * PRIME_2;
+    accumulator = std::rotl(accumulator, 31);
+    return accumulator * PRIME_1;
+}
+
+std::uint64_t merge_round(std::uint64_t hash, std::uint64_t const accumulator) {
+    hash ^= round(0, accumulator);
+    return hash * PRIME_1 + PRIME_4;
+}
+
+}// anonymous namespace
+
+XXHash64::XXHash64(std::uint64_t const seed)
+    : m_accumulators{ seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1 },
+      m_buffer{},
+      m_buffered{ 0 },
+      m_total{ 0 },
+      m_seed{ seed } { }
+
+void XXHash64::update(void const *data, std::size_t size) {
+    auto const *bytes = static_cast<std::uint8_t const *>(data);
+    m_total += size;
+
+    // Complete the buffered stripe first
+    if (m_buffered > 0) {
+        auto const missing = std::min(size, m_buffer.size() - m_buffered);
+        std::memcpy(m_buffer.data() + m_buffered, bytes, missing);
+        m_buffered += missing;
+        bytes += missing;
+        size -= missing;
+
+        if (m_buffered < m_buffer.size()) {
+            return;
+        }
+        consume(m_buffer.data());
+        m_buffered = 0;
+    }
+
+    for (; size >= m_buffer.size(); bytes += m_buffer.size(), size -= m_buffer.size()) {
+        consume(bytes);
+    }
+
+    std::memcpy(m_buffer.data(), bytes, size);
+    m_buffered = size;
+}
+
+std::uint64_t XXHash64::digest() const {
+    std::uint64_t hash;
+    if (m_total >= m_buffer.size()) {
+        hash = std::rotl(m_accumulators[0], 1) + std::rotl(m_accumulators[1], 7) + std::rotl(m_accumulators[2], 12) +
+               std::rotl(m_accumulators[3], 18);
+        for (auto const accumulator : m_accumulators) {
+            hash = merge_round(hash, accumulator);
+        }
+    } else {
+        hash = m_seed + PRIME_5;
+    }
+    hash += m_total;
+
+    // The remaining bytes are mixed in by 8, 4 and 1 bytes
+    auto const *bytes = m_buffer.data();
+    auto remaining = m_buffered;
+    for (; remaining >= 8; bytes += 8, remaining -= 8) {
+        hash ^= round(0, read64(bytes));
+        hash = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+    }
+    if (remaining >= 4) {
+        hash ^= static_cast<std::uint64_t>(read32(bytes)) * PRIME_1;
+        hash = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+        bytes += 4;
+        remaining -= 4;
+    }
+    for (; remaining > 0; ++bytes, --remaining) {
+        hash ^= static_cast<std::uint64_t>(*bytes) * PRIME_5;
+        hash = std::rotl(hash, 11) * PRIME_1;
+    }
+
+    // Final avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+void XXHash64::consume(std::uint8_t const *stripe) {
+    for (std::size_t i = 0; i < m_accumulators.size(); ++i) {
+        m_accumulators[i] = round(m_accumulators[i], read64(stripe + i * 8));
+    }
+}
+
+}// namespace utils
@@ -0,0 +1,74 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef UTILS_HASH_H
+#define UTILS_HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace utils {
+
+/**
+ * Incremental implementation of the XXH64 hash, a fast non-cryptographic hash.
+ * The data may be passed in arbitrary pieces, the digest equals the hash of their concatenation.
+ */
+class XXHash64 {
+public:
+    /**
+     * Starts a new hash
+     * @param seed The seed of the hash
+     */
+    explicit XXHash64(std::uint64_t seed = 0);
+
+    /**
+     * Adds data to the hash
+     * @param data The data
+     * @param size The size of the data in bytes
+     */
+    void update(void const *data, std::size_t size);
+
+    /**
+     * Computes the hash of all data so far, more data may be added afterwards
+     * @return The hash
+     */
+    [[nodiscard]] std::uint64_t digest() const;
+
+private:
+    /**
+     * Consumes one stripe of 32 bytes
+     * @param stripe The stripe
+     */
+    void consume(std::uint8_t const *stripe);
+
+    std::array<std::uint64_t, 4> m_accumulators;
+    std::array<std::uint8_t, 32> m_buffer;
+    std::size_t m_buffered;
+    std::uint64_t m_total;
+    std::uint64_t m_seed;
+};
+
+}// namespace utils
+
+#endif// UTILS_HASH_H
@@ -0,0 +1,108 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef UTILS_SPSC_QUEUE_H
+#define UTILS_SPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace utils {
+
+/**
+ * A bounded lock-free queue for exactly one producer thread and one consumer thread
+ * @tparam Type The type of the elements
+ */
+template<typename Type>
+class SpscQueue {
+public:
+    /**
+     * Instantiates a new empty queue
+     * @param capacity The minimum amount of elements the queue holds, it is rounded up to a power of two
+     */
+    explicit SpscQueue(std::size_t const capacity)
+        : m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 1))),
+          m_mask{ m_slots.size() - 1 },
+          m_head{ 0 },
+          m_tail{ 0 } { }
+
+    SpscQueue(SpscQueue const &) = delete;
+    SpscQueue &operator=(SpscQueue const &) = delete;
+
+    /**
+     * Appends an element, only called by the producer
+     * @param value The element, which is only moved from if there is space
+     * @return Whether there was space for the element
+     */
+    bool try_push(Type &value) {
+        auto const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+            return false;
+        }
+
+        m_slots[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest element, only called by the consumer
+     * @return The element, or nothing if the queue is empty
+     */
+    std::optional<Type> try_pop() {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        std::optional<Type> value{ std::move(m_slots[head & m_mask]) };
+        m_head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * The amount of elements in the queue, which may be outdated immediately if called concurrently
+     * @return The amount of elements
+     */
+    [[nodiscard]] std::size_t size() const {
+        // The head is read first, so it never overtakes the tail
+        auto const head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+private:
+    std::vector<Type> m_slots;
+    std::size_t m_mask;
+
+    // The positions only ever grow, they are kept on separate cache lines as each is written by another thread
+    alignas(64) std::atomic<std::size_t> m_head;
+    alignas(64) std::atomic<std::size_t> m_tail;
+};
+
+}// namespace utils
+
+#endif// UTILS_SPSC_QUEUE_H
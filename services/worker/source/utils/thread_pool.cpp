@@ -0,0 +1,82 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace utils {
+
+ThreadPool::ThreadPool(std::size_t const threads) : m_stopped{ false } {
+    auto const count = std::max<std::size_t>(threads, 1);
+    m_threads.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_threads.emplace_back([this] { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_stopped = true;
+    }
+
+    m_available.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return m_threads.size();
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::scoped_lock lock{ m_mutex };
+        m_tasks.push(std::move(task));
+    }
+    m_available.notify_one();
+}
+
+void ThreadPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{ m_mutex };
+            m_available.wait(lock, [this] { return m_stopped or not m_tasks.empty(); });
+
+            // Pending tasks are still executed when the pool is stopped
+            if (m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
+
+}// namespace utils
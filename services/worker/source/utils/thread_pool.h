@@ -0,0 +1,90 @@
+//
+// MIT License
+//
+// Copyright (c) 2025 multimedia-workforce
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+/**
+ * A fixed-size pool of worker threads that execute submitted tasks in FIFO order
+ */
+class ThreadPool {
+public:
+    /**
+     * Starts the worker threads of the pool
+     * @param threads The amount of worker threads, at least one thread is started
+     */
+    explicit ThreadPool(std::size_t threads);
+
+    /**
+     * Finishes all pending tasks and joins the worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    /**
+     * Submits a task to the pool
+     * @tparam Task The type of the task
+     * @param task The task, which is executed on one of the worker threads
+     * @return A future that holds the result of the task
+     */
+    template<typename Task>
+    auto submit(Task &&task) {
+        using ResultType = std::invoke_result_t<std::decay_t<Task>>;
+        auto packaged = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Task>(task));
+        auto future = packaged->get_future();
+        enqueue([packaged] { (*packaged)(); });
+        return future;
+    }
+
+    /**
+     * The amount of worker threads
+     * @return The amount of worker threads
+     */
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    void enqueue(std::function<void()> task);
+    void run();
+
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_available;
+    bool m_stopped;
+};
+
+}// namespace utils
+
+#endif// UTILS_THREAD_POOL_H
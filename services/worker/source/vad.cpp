@@ -0,0 +1,320 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "vad.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#define VAD_X86 1
+#endif
+
+namespace {
+
+// Padding that is kept before and after speech, so the onsets and endings of words are not clipped
+constexpr usize PADDING_FRAMES = 10;
+
+// The amount of samples that is read from the PCM stream at once
+constexpr usize READ_SIZE = VoiceDetector::FRAME_SIZE * 100;
+
+// Window boundaries are placed in the middle of the quietest block of this many samples (10 ms)
+constexpr usize BOUNDARY_BLOCK_SIZE = 160;
+
+// Frames must be this much louder than the noise floor to be considered speech
+constexpr f32 SPEECH_MARGIN_DB = 10.0f;
+
+// Frames below this level are never considered speech
+constexpr f32 MIN_SPEECH_DB = -50.0f;
+
+// The noise floor never drops below this level, e.g. on digital silence
+constexpr f32 MIN_NOISE_FLOOR_DB = -90.0f;
+
+// How fast the noise floor rises per frame, it drops to quieter frames immediately
+constexpr f32 NOISE_FLOOR_RISE = 0.002f;
+
+// Zero-crossing rate from which a frame sounds like broadband noise rather than voiced speech
+constexpr f32 NOISE_CROSSING_RATE = 0.4f;
+
+/**
+ * The statistics of a frame that the energy detector is based on
+ */
+struct FrameStatistics {
+    // The sum of the squared samples
+    f32 energy;
+
+    // The amount of sign changes between consecutive samples
+    usize crossings;
+};
+
+FrameStatistics statistics_scalar(s16 const *samples, usize const count) {
+    FrameStatistics statistics{ .energy = 0.0f, .crossings = 0 };
+    for (usize i = 0; i < count; ++i) {
+        auto const sample = static_cast<f32>(samples[i]);
+        statistics.energy += sample * sample;
+    }
+    for (usize i = 1; i < count; ++i) {
+        statistics.crossings += (samples[i] ^ samples[i - 1]) < 0 ? 1 : 0;
+    }
+    return statistics;
+}
+
+#ifdef VAD_X86
+
+__attribute__((target("avx2,fma"))) FrameStatistics statistics_avx2(s16 const *samples, usize const count) {
+    auto energy = _mm256_setzero_ps();
+    usize i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto const values = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(samples + i)));
+        auto const floats = _mm256_cvtepi32_ps(values);
+        energy = _mm256_fmadd_ps(floats, floats, energy);
+    }
+
+    auto sum = _mm_add_ps(_mm256_castps256_ps128(energy), _mm256_extractf128_ps(energy, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+
+    FrameStatistics statistics{ .energy = _mm_cvtss_f32(sum), .crossings = 0 };
+    for (; i < count; ++i) {
+        auto const sample = static_cast<f32>(samples[i]);
+        statistics.energy += sample * sample;
+    }
+
+    // The sign bit of the xor of neighbouring samples is set where the sign changes
+    usize j = 1;
+    for (; j + 16 <= count; j += 16) {
+        auto const current = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(samples + j));
+        auto const previous = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(samples + j - 1));
+        auto const changes = _mm256_srai_epi16(_mm256_xor_si256(current, previous), 15);
+
+        // Every 16 bit lane contributes two bits to the byte mask
+        statistics.crossings += static_cast<usize>(std::popcount(static_cast<u32>(_mm256_movemask_epi8(changes)))) / 2;
+    }
+    for (; j < count; ++j) {
+        statistics.crossings += (samples[j] ^ samples[j - 1]) < 0 ? 1 : 0;
+    }
+    return statistics;
+}
+
+#endif
+
+/**
+ * Selects the statistics kernel once at startup, depending on the capabilities of the CPU
+ * @return The statistics kernel
+ */
+auto select_statistics() {
+#ifdef VAD_X86
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")) {
+        return statistics_avx2;
+    }
+#endif
+    return statistics_scalar;
+}
+
+auto const STATISTICS = select_statistics();
+
+}// anonymous namespace
+
+EnergyDetector::EnergyDetector() : m_noise_floor{ MIN_NOISE_FLOOR_DB }, m_initialized{ false } { }
+
+bool EnergyDetector::is_speech(std::span<s16 const> const frame) {
+    if (frame.empty()) {
+        return false;
+    }
+
+    auto const statistics = STATISTICS(frame.data(), frame.size());
+    auto const mean_square = statistics.energy / (32768.0f * 32768.0f * static_cast<f32>(frame.size()));
+    auto const level = 10.0f * std::log10(mean_square + 1e-12f);
+    auto const crossing_rate = static_cast<f32>(statistics.crossings) / static_cast<f32>(frame.size());
+
+    // The noise floor follows quieter frames immediately and rises slowly during louder frames
+    if (not m_initialized or level < m_noise_floor) {
+        m_noise_floor = std::max(level, MIN_NOISE_FLOOR_DB);
+        m_initialized = true;
+    } else {
+        m_noise_floor += NOISE_FLOOR_RISE * (level - m_noise_floor);
+    }
+
+    return level >= MIN_SPEECH_DB and level >= m_noise_floor + SPEECH_MARGIN_DB and
+           crossing_rate < NOISE_CROSSING_RATE;
+}
+
+SpeechStream::SpeechStream(PcmStream &pcm_stream,
+                           std::unique_ptr<VoiceDetector> detector,
+                           usize const boundary_tolerance)
+    : m_pcm_stream{ pcm_stream },
+      m_detector{ std::move(detector) },
+      m_boundary_tolerance{ boundary_tolerance },
+      m_padding_source{ 0 },
+      m_hangover{ 0 },
+      m_offset{ 0 },
+      m_total{ 0 },
+      m_kept{ 0 },
+      m_finished{ false } { }
+
+std::span<s16 const> SpeechStream::next_window(usize const size) {
+    // Without a detector and boundary search, the windows of the PCM stream are passed through
+    if (not m_detector and m_boundary_tolerance == 0) {
+        auto const window = m_pcm_stream.next_window(size);
+        m_total += window.size();
+        m_kept += window.size();
+        return window;
+    }
+
+    // One sample more than the window is required to know whether the stream continues after it
+    if (m_output.size() - m_offset <= size and not m_finished) {
+        // Drop the samples of the previous windows
+        m_output.erase(m_output.begin(), m_output.begin() + static_cast<ssize>(m_offset));
+        m_offset = 0;
+
+        while (m_output.size() <= size and not m_finished) {
+            read_more();
+        }
+    }
+
+    auto const available = m_output.size() - m_offset;
+    auto const count = available > size ? find_boundary(size) : available;
+    std::span<s16 const> const window{ m_output.data() + m_offset, count };
+    m_offset += count;
+    return window;
+}
+
+usize SpeechStream::source_position(usize const position) const {
+    // Find the last span that starts at or before the position
+    auto const span = std::upper_bound(m_spans.begin(), m_spans.end(), position,
+                                       [](usize const value, Span const &span) { return value < span.position; });
+    if (span == m_spans.begin()) {
+        return position;
+    }
+    return std::prev(span)->source + (position - std::prev(span)->position);
+}
+
+usize SpeechStream::total_samples() const {
+    return m_total;
+}
+
+usize SpeechStream::speech_samples() const {
+    return m_kept;
+}
+
+void SpeechStream::read_more() {
+    auto const block = m_pcm_stream.next_window(READ_SIZE);
+
+    // Without a detector, every sample is speech
+    if (not m_detector) {
+        if (block.empty()) {
+            m_finished = true;
+        } else {
+            keep(block, m_total);
+            m_total += block.size();
+        }
+        return;
+    }
+
+    if (block.empty()) {
+        // The last incomplete frame is classified on its own
+        if (not m_input.empty()) {
+            process_frame(m_input);
+            m_input.clear();
+        }
+        m_finished = true;
+        return;
+    }
+
+    m_input.insert(m_input.end(), block.begin(), block.end());
+
+    usize frame = 0;
+    for (; frame + VoiceDetector::FRAME_SIZE <= m_input.size(); frame += VoiceDetector::FRAME_SIZE) {
+        process_frame(std::span<s16 const>{ m_input }.subspan(frame, VoiceDetector::FRAME_SIZE));
+    }
+    m_input.erase(m_input.begin(), m_input.begin() + static_cast<ssize>(frame));
+}
+
+void SpeechStream::process_frame(std::span<s16 const> const frame) {
+    auto const source = m_total;
+    m_total += frame.size();
+
+    if (m_detector->is_speech(frame)) {
+        // The padding before the speech is kept as well
+        if (not m_padding.empty()) {
+            keep(m_padding, m_padding_source);
+            m_padding.clear();
+        }
+        keep(frame, source);
+        m_hangover = PADDING_FRAMES;
+        return;
+    }
+
+    // The frames right after speech are kept, the speech might only fade out
+    if (m_hangover > 0) {
+        --m_hangover;
+        keep(frame, source);
+        return;
+    }
+
+    // Non-speech is held back as padding, only the most recent frames are kept
+    if (m_padding.empty()) {
+        m_padding_source = source;
+    }
+    m_padding.insert(m_padding.end(), frame.begin(), frame.end());
+
+    auto constexpr padding_size = PADDING_FRAMES * VoiceDetector::FRAME_SIZE;
+    if (m_padding.size() > padding_size) {
+        auto const dropped = m_padding.size() - padding_size;
+        m_padding.erase(m_padding.begin(), m_padding.begin() + static_cast<ssize>(dropped));
+        m_padding_source += dropped;
+    }
+}
+
+usize SpeechStream::find_boundary(usize const size) const {
+    auto const tolerance = std::min(m_boundary_tolerance, size);
+    if (tolerance < BOUNDARY_BLOCK_SIZE) {
+        return size;
+    }
+
+    // The block with the lowest energy within the tolerance band, searched backwards from the end of the window
+    auto const *window = m_output.data() + m_offset;
+    auto boundary = size;
+    auto lowest = std::numeric_limits<f32>::max();
+    for (auto end = size; end >= size - tolerance + BOUNDARY_BLOCK_SIZE; end -= BOUNDARY_BLOCK_SIZE) {
+        auto const energy = STATISTICS(window + end - BOUNDARY_BLOCK_SIZE, BOUNDARY_BLOCK_SIZE).energy;
+        if (energy < lowest) {
+            lowest = energy;
+            boundary = end - BOUNDARY_BLOCK_SIZE / 2;
+        }
+    }
+    return boundary;
+}
+
+void SpeechStream::keep(std::span<s16 const> const samples, usize const source) {
+    // A new span starts wherever samples were dropped in between
+    if (m_spans.empty() or m_spans.back().source + (m_kept - m_spans.back().position) != source) {
+        m_spans.push_back(Span{ .position = m_kept, .source = source });
+    }
+
+    m_output.insert(m_output.end(), samples.begin(), samples.end());
+    m_kept += samples.size();
+}
@@ -0,0 +1,181 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef VAD_H
+#define VAD_H
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "decode.h"
+#include "types.h"
+
+/**
+ * A VoiceDetector classifies consecutive frames of 16 kHz mono PCM as speech or non-speech.
+ * Detectors may keep state across frames, hence every request uses its own detector.
+ * The EnergyDetector is the built-in detector, model-based detectors implement this interface.
+ */
+class VoiceDetector {
+public:
+    // The size of one frame, which is 30 ms at 16 kHz
+    static constexpr usize FRAME_SIZE = 480;
+
+    virtual ~VoiceDetector() = default;
+
+    /**
+     * Classifies the next frame
+     * @param frame The samples of the frame, at most FRAME_SIZE samples
+     * @return Whether the frame contains speech
+     */
+    [[nodiscard]] virtual bool is_speech(std::span<s16 const> frame) = 0;
+};
+
+/**
+ * Creates a voice detector for a request
+ */
+using VoiceDetectorFactory = std::function<std::unique_ptr<VoiceDetector>()>;
+
+/**
+ * The EnergyDetector classifies frames by their energy relative to an adaptive noise floor.
+ * Frames with a zero-crossing rate as high as white noise are not considered speech on their own.
+ */
+class EnergyDetector final : public VoiceDetector {
+public:
+    EnergyDetector();
+
+    [[nodiscard]] bool is_speech(std::span<s16 const> frame) override;
+
+private:
+    f32 m_noise_floor;
+    bool m_initialized;
+};
+
+/**
+ * The SpeechStream removes non-speech spans from a PCM stream. Speech is kept with some padding,
+ * so the onsets and endings of words are not clipped. The positions of the kept samples in the
+ * original stream are remembered, hence timings can be mapped back. Without a detector, all
+ * samples of the PCM stream are kept. Windows may end at the quietest point shortly before
+ * their maximum size, so words are not cut in half at window boundaries.
+ */
+class SpeechStream {
+public:
+    /**
+     * Instantiates a speech stream on top of a PCM stream
+     * @param pcm_stream The PCM stream, which must outlive the speech stream
+     * @param detector The voice detector, or nullptr to keep all samples
+     * @param boundary_tolerance How many samples a window may end before its maximum size to end
+     *                           at a quiet point, 0 cuts windows at their maximum size
+     */
+    SpeechStream(PcmStream &pcm_stream, std::unique_ptr<VoiceDetector> detector, usize boundary_tolerance = 0);
+
+    /**
+     * Retrieves the next window of speech samples. Unless the stream ends within the window,
+     * the window ends at the quietest point within the boundary tolerance before its maximum size.
+     * @param size The maximum amount of samples in the window
+     * @return Up to size samples, which stay valid until the next call. An empty window marks the end.
+     */
+    [[nodiscard]] std::span<s16 const> next_window(usize size);
+
+    /**
+     * Maps a position in the speech stream to the position in the PCM stream
+     * @param position The position in the speech stream
+     * @return The position of the sample in the PCM stream
+     */
+    [[nodiscard]] usize source_position(usize position) const;
+
+    /**
+     * The amount of samples that were read from the PCM stream so far
+     * @return The amount of samples
+     */
+    [[nodiscard]] usize total_samples() const;
+
+    /**
+     * The amount of samples that were kept as speech so far
+     * @return The amount of samples
+     */
+    [[nodiscard]] usize speech_samples() const;
+
+private:
+    /**
+     * A continuous span of kept samples
+     */
+    struct Span {
+        // The position of the first sample in the speech stream
+        usize position;
+
+        // The position of the first sample in the PCM stream
+        usize source;
+    };
+
+    /**
+     * Reads the next block of the PCM stream and classifies its frames
+     */
+    void read_more();
+
+    /**
+     * Classifies one frame and keeps it, holds it back as padding or drops it
+     * @param frame The samples of the frame
+     */
+    void process_frame(std::span<s16 const> frame);
+
+    /**
+     * Finds the quietest point within the boundary tolerance before the end of a full window
+     * @param size The maximum amount of samples in the window
+     * @return The amount of samples of the window
+     */
+    [[nodiscard]] usize find_boundary(usize size) const;
+
+    /**
+     * Appends samples to the output
+     * @param samples The samples
+     * @param source The position of the first sample in the PCM stream
+     */
+    void keep(std::span<s16 const> samples, usize source);
+
+    PcmStream &m_pcm_stream;
+    std::unique_ptr<VoiceDetector> m_detector;
+    usize m_boundary_tolerance;
+
+    // Samples of an incomplete frame, which are classified once the frame is complete
+    std::vector<s16> m_input;
+
+    // Recent non-speech samples that are kept if speech follows, and their position in the PCM stream
+    std::vector<s16> m_padding;
+    usize m_padding_source;
+
+    // The remaining amount of frames that are kept after speech
+    usize m_hangover;
+
+    // The kept samples and the read cursor of the windows
+    std::vector<s16> m_output;
+    usize m_offset;
+
+    std::vector<Span> m_spans;
+    usize m_total;
+    usize m_kept;
+    bool m_finished;
+};
+
+#endif// VAD_H
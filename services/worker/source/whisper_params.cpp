@@ -0,0 +1,80 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "whisper_params.h"
+
+#include <algorithm>
+
+namespace {
+
+// The encoder of whisper processes one audio context frame per 20 ms, i.e. 320 samples
+constexpr usize SAMPLES_PER_AUDIO_CTX = 320;
+
+// Short audio contexts are rounded up to multiples of this size, so only a few context sizes occur
+constexpr usize AUDIO_CTX_BUCKET = 256;
+
+// Whisper degrades on very short contexts and on speech right at their end, hence contexts
+// are never shorter than the minimum and always extend by the margin past the window
+constexpr usize MIN_AUDIO_CTX = 512;
+constexpr usize AUDIO_CTX_MARGIN = 64;
+
+}// anonymous namespace
+
+int fit_audio_ctx(whisper_context *context, usize const samples) {
+    auto const full = static_cast<usize>(whisper_model_n_audio_ctx(context));
+    auto const required = (samples + SAMPLES_PER_AUDIO_CTX - 1) / SAMPLES_PER_AUDIO_CTX + AUDIO_CTX_MARGIN;
+    auto const rounded = (required + AUDIO_CTX_BUCKET - 1) / AUDIO_CTX_BUCKET * AUDIO_CTX_BUCKET;
+    auto const bucket = std::max(MIN_AUDIO_CTX, rounded);
+    return bucket >= full ? 0 : static_cast<int>(bucket);
+}
+
+whisper_full_params profile_params(transcriber::Profile const profile, usize const threads) {
+    switch (profile) {
+        case transcriber::PROFILE_FAST: {
+            // Greedy search on all threads of the state, a failed window is not retried at higher temperatures
+            auto params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+            params.greedy.best_of = 1;
+            params.temperature_inc = 0.0f;
+            params.no_context = true;
+            params.n_threads = static_cast<int>(threads);
+            return params;
+        }
+        case transcriber::PROFILE_ACCURATE: {
+            // A wider beam and more candidates on temperature fallback. The whisper states are shared between
+            // requests, so the text that whisper keeps in the state must not prompt the next window. The
+            // request carries its own text from window to window, see WindowSession in transcriber.cpp.
+            auto params = whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH);
+            params.beam_search.beam_size = 8;
+            params.greedy.best_of = 5;
+            params.no_context = true;
+            params.n_threads = static_cast<int>(std::min(threads, static_cast<usize>(params.n_threads)));
+            return params;
+        }
+        default: {
+            // Beam search performs better than greedy search
+            auto params = whisper_full_default_params(WHISPER_SAMPLING_BEAM_SEARCH);
+            params.n_threads = static_cast<int>(std::min(threads, static_cast<usize>(params.n_threads)));
+            return params;
+        }
+    }
+}
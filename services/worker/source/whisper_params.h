@@ -0,0 +1,50 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef WHISPER_PARAMS_H
+#define WHISPER_PARAMS_H
+
+#include <whisper.h>
+
+#include <transcriber.grpc.pb.h>
+
+#include "types.h"
+
+/**
+ * Sizes the encoder context of whisper to the length of a window. By default, whisper encodes
+ * 30 seconds of audio, even if the window is much shorter.
+ * @param context The whisper context, which determines the full audio context
+ * @param samples The amount of samples in the window
+ * @return The audio context, 0 for the full audio context
+ */
+[[nodiscard]] int fit_audio_ctx(whisper_context *context, usize samples);
+
+/**
+ * Maps a profile to the whisper parameters that trade latency for quality
+ * @param profile The profile of the request
+ * @param threads The amount of threads that one whisper state may use
+ * @return The whisper parameters, without the segment callback
+ */
+[[nodiscard]] whisper_full_params profile_params(transcriber::Profile profile, usize threads);
+
+#endif// WHISPER_PARAMS_H
@@ -0,0 +1,156 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include "whisper_pool.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include <unistd.h>
+
+namespace {
+
+/**
+ * Reads the resident memory of the process
+ * @return The resident memory in bytes, or 0 if it is unknown
+ */
+usize resident_memory() {
+    std::ifstream statm{ "/proc/self/statm" };
+    usize total_pages = 0;
+    usize resident_pages = 0;
+    if (not(statm >> total_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<usize>(sysconf(_SC_PAGESIZE));
+}
+
+}// anonymous namespace
+
+WhisperPool::Lease::Lease(WhisperPool *pool, whisper_state *state) : m_pool{ pool }, m_state{ state } { }
+
+WhisperPool::Lease::Lease(Lease &&other) noexcept
+    : m_pool{ std::exchange(other.m_pool, nullptr) },
+      m_state{ std::exchange(other.m_state, nullptr) } { }
+
+WhisperPool::Lease &WhisperPool::Lease::operator=(Lease &&other) noexcept {
+    if (this != &other) {
+        if (m_pool) {
+            m_pool->release(m_state);
+        }
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_state = std::exchange(other.m_state, nullptr);
+    }
+    return *this;
+}
+
+WhisperPool::Lease::~Lease() {
+    if (m_pool) {
+        m_pool->release(m_state);
+    }
+}
+
+whisper_context *WhisperPool::Lease::context() const {
+    return m_pool->m_context;
+}
+
+whisper_state *WhisperPool::Lease::state() const {
+    return m_state;
+}
+
+Result<std::unique_ptr<WhisperPool>> WhisperPool::create(std::filesystem::path const &model_path, usize const size) {
+    // The weights are loaded without a state, every transcription gets its own state from the pool
+    auto *context =
+            whisper_init_from_file_with_params_no_state(model_path.string().c_str(), whisper_context_default_params());
+    if (not context) {
+        return tl::unexpected("Failed to initialize whisper context.");
+    }
+
+    // The memory of a state is measured as the largest growth of the resident memory across the states,
+    // which is approximate as other threads allocate concurrently
+    std::unique_ptr<WhisperPool> pool{ new WhisperPool{ context } };
+    for (usize i = 0; i < std::max<usize>(size, 1); ++i) {
+        auto const before = resident_memory();
+        auto *state = whisper_init_state(context);
+        if (not state) {
+            return tl::unexpected("Failed to initialize whisper state.");
+        }
+
+        auto const after = resident_memory();
+        pool->m_state_memory = std::max(pool->m_state_memory, after > before ? after - before : 0);
+        pool->m_states.push_back(state);
+    }
+
+    pool->m_idle = pool->m_states;
+    return pool;
+}
+
+WhisperPool::WhisperPool(whisper_context *context) : m_context{ context }, m_state_memory{ 0 } { }
+
+WhisperPool::~WhisperPool() {
+    for (auto *state : m_states) {
+        whisper_free_state(state);
+    }
+    whisper_free(m_context);
+}
+
+WhisperPool::Lease WhisperPool::acquire(std::string const &user, f64 const weight, f64 const cost) {
+    std::unique_lock lock{ m_mutex };
+
+    // Without waiting requests, there is nothing to be fair about
+    if (m_waiters.empty() and not m_idle.empty()) {
+        auto *state = m_idle.back();
+        m_idle.pop_back();
+        return Lease{ this, state };
+    }
+
+    Waiter waiter{ .granted = {}, .state = nullptr };
+    m_waiters.push(user, weight, cost, &waiter);
+
+    dispatch();
+    waiter.granted.wait(lock, [&waiter] { return waiter.state != nullptr; });
+    return Lease{ this, waiter.state };
+}
+
+usize WhisperPool::size() const {
+    return m_states.size();
+}
+
+usize WhisperPool::state_memory() const {
+    return m_state_memory;
+}
+
+void WhisperPool::release(whisper_state *state) {
+    std::lock_guard lock{ m_mutex };
+    m_idle.push_back(state);
+    dispatch();
+}
+
+void WhisperPool::dispatch() {
+    while (not m_idle.empty() and not m_waiters.empty()) {
+        auto *waiter = *m_waiters.pop();
+        waiter->state = m_idle.back();
+        m_idle.pop_back();
+        waiter->granted.notify_one();
+    }
+}
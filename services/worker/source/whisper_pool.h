@@ -0,0 +1,151 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#ifndef WHISPER_POOL_H
+#define WHISPER_POOL_H
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <whisper.h>
+
+#include "types.h"
+#include "utils/fair_scheduler.h"
+
+/**
+ * The WhisperPool loads the model weights once and shares them between a fixed amount of
+ * whisper states. Every state holds the buffers of one transcription, hence as many
+ * transcriptions as there are states run concurrently. Requests check out a state for a
+ * window and return it afterwards, so waiting requests are served in between.
+ *
+ * Waiting requests are served per user with deficit round robin: every round, a user may
+ * check out windows worth its weight, so a user with many requests does not crowd out
+ * the others. Capacity that the other users leave idle is still used by that user.
+ */
+class WhisperPool {
+public:
+    /**
+     * A checked out whisper state, which is returned to the pool on destruction
+     */
+    class Lease {
+    public:
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        ~Lease();
+
+        Lease(Lease const &) = delete;
+        Lease &operator=(Lease const &) = delete;
+
+        /**
+         * The shared context that holds the model weights
+         * @return The whisper context
+         */
+        [[nodiscard]] whisper_context *context() const;
+
+        /**
+         * The state that is exclusively owned by the lease
+         * @return The whisper state
+         */
+        [[nodiscard]] whisper_state *state() const;
+
+    private:
+        friend class WhisperPool;
+
+        Lease(WhisperPool *pool, whisper_state *state);
+
+        WhisperPool *m_pool;
+        whisper_state *m_state;
+    };
+
+    /**
+     * Loads the model and initializes the states
+     * @param model_path The path to the whisper model
+     * @param size The amount of states, which is the amount of concurrent transcriptions
+     * @return The pool or an error if the model or a state cannot be initialized
+     */
+    [[nodiscard]] static Result<std::unique_ptr<WhisperPool>> create(std::filesystem::path const &model_path,
+                                                                     usize size);
+    ~WhisperPool();
+
+    WhisperPool(WhisperPool const &) = delete;
+    WhisperPool &operator=(WhisperPool const &) = delete;
+
+    /**
+     * Checks out a state, blocks until one is available and it is the turn of the user
+     * @param user The user on whose behalf the state is checked out
+     * @param weight The share of the user relative to other users, 1 by default
+     * @param cost The cost of the window relative to a full window of 30 seconds
+     * @return The lease of the state
+     */
+    [[nodiscard]] Lease acquire(std::string const &user, f64 weight, f64 cost);
+
+    /**
+     * The amount of states in the pool
+     * @return The amount of states
+     */
+    [[nodiscard]] usize size() const;
+
+    /**
+     * The resident memory that one state occupied after its initialization. Whisper does not report the size of
+     * its buffers, so this is the growth of the resident memory of the process around the initialization, which
+     * allocations of other threads and memory the allocator keeps make approximate.
+     * @return The approximate memory in bytes
+     */
+    [[nodiscard]] usize state_memory() const;
+
+private:
+    explicit WhisperPool(whisper_context *context);
+
+    /**
+     * A request that waits for a state
+     */
+    struct Waiter {
+        std::condition_variable granted;
+        whisper_state *state;
+    };
+
+    /**
+     * Returns a state to the pool and hands it to the next waiting request
+     * @param state The state that was checked out
+     */
+    void release(whisper_state *state);
+
+    /**
+     * Hands the idle states to the waiting requests whose users are next, called with the lock held
+     */
+    void dispatch();
+
+    whisper_context *m_context;
+    std::vector<whisper_state *> m_states;
+    usize m_state_memory;
+
+    std::mutex m_mutex;
+    std::vector<whisper_state *> m_idle;
+    utils::FairScheduler<Waiter *> m_waiters;
+};
+
+#endif// WHISPER_POOL_H
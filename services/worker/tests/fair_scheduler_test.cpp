@@ -0,0 +1,124 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "utils/fair_scheduler.h"
+
+namespace {
+
+/**
+ * Pops items until the scheduler is empty or enough items were popped
+ * @param scheduler The scheduler
+ * @param count The maximum amount of items
+ * @return The items in the order they were popped
+ */
+std::string pop(utils::FairScheduler<char> &scheduler, usize const count = 100) {
+    std::string order;
+    while (order.size() < count) {
+        auto const item = scheduler.pop();
+        if (not item) {
+            break;
+        }
+        order += *item;
+    }
+    return order;
+}
+
+/**
+ * Pushes items of a user, every item is the first letter of the user
+ * @param scheduler The scheduler
+ * @param user The user
+ * @param weight The weight of the user
+ * @param cost The cost of every item
+ * @param count The amount of items
+ */
+void push(utils::FairScheduler<char> &scheduler,
+          std::string const &user,
+          f64 const weight,
+          f64 const cost,
+          usize const count) {
+    for (usize i = 0; i < count; ++i) {
+        scheduler.push(user, weight, cost, user.front());
+    }
+}
+
+}// anonymous namespace
+
+TEST(FairSchedulerTest, IsEmptyWithoutItems) {
+    utils::FairScheduler<char> scheduler;
+    EXPECT_TRUE(scheduler.empty());
+    EXPECT_FALSE(scheduler.pop());
+
+    push(scheduler, "alice", 1.0, 1.0, 1);
+    EXPECT_FALSE(scheduler.empty());
+    EXPECT_EQ(pop(scheduler), "a");
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(FairSchedulerTest, AlternatesBetweenEqualWeights) {
+    utils::FairScheduler<char> scheduler;
+    push(scheduler, "alice", 1.0, 1.0, 6);
+    push(scheduler, "bob", 1.0, 1.0, 3);
+
+    // Once bob has no items left, alice takes the rest
+    EXPECT_EQ(pop(scheduler), "abababaaa");
+}
+
+TEST(FairSchedulerTest, SharesInProportionToTheWeights) {
+    utils::FairScheduler<char> scheduler;
+    push(scheduler, "alice", 2.0, 1.0, 8);
+    push(scheduler, "bob", 1.0, 1.0, 8);
+    EXPECT_EQ(pop(scheduler, 9), "aabaabaab");
+}
+
+TEST(FairSchedulerTest, ChargesTheCostOfItems) {
+    utils::FairScheduler<char> scheduler;
+    push(scheduler, "alice", 1.0, 0.5, 8);
+    push(scheduler, "bob", 1.0, 1.0, 8);
+
+    // Items of half the cost, like short trailing windows, are taken two per turn
+    EXPECT_EQ(pop(scheduler, 9), "aabaabaab");
+}
+
+TEST(FairSchedulerTest, ForgetsTheDeficitOfUsersThatLeave) {
+    utils::FairScheduler<char> scheduler;
+    push(scheduler, "alice", 1.0, 0.4, 1);
+    EXPECT_EQ(pop(scheduler), "a");
+
+    // A saved deficit of 0.6 would allow alice to take both of her items in her first turn
+    push(scheduler, "alice", 1.0, 0.8, 2);
+    push(scheduler, "bob", 1.0, 1.0, 2);
+    EXPECT_EQ(pop(scheduler), "abab");
+}
+
+TEST(FairSchedulerTest, ServesUsersWithoutWeight) {
+    utils::FairScheduler<char> scheduler;
+    push(scheduler, "alice", 0.0, 1.0, 1);
+    push(scheduler, "bob", 1.0, 1.0, 1000);
+    EXPECT_NE(pop(scheduler, 1000).find('a'), std::string::npos);
+}
@@ -0,0 +1,210 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+#include "fingerprint.h"
+
+namespace {
+
+constexpr usize SAMPLE_RATE = 16000;
+
+// The user and the settings of the transcripts in the index
+constexpr auto USER = "alice";
+constexpr auto SETTINGS = "model";
+
+/**
+ * Generates audio of four tones between 200 and 2000 Hz that change every 150 ms, like a melody
+ * @param seed The seed of the melody
+ * @param seconds The length of the audio
+ * @return The 16 kHz mono samples
+ */
+std::vector<s16> melody(u32 const seed, usize const seconds) {
+    std::mt19937 random{ seed };
+    std::uniform_real_distribution<f32> frequency{ 200.0f, 2000.0f };
+
+    std::vector<s16> pcm(seconds * SAMPLE_RATE);
+    f32 tones[4]{};
+    for (usize i = 0; i < pcm.size(); ++i) {
+        if (i % 2400 == 0) {
+            std::ranges::generate(tones, [&] { return frequency(random); });
+        }
+        f32 sample = 0.0f;
+        for (auto const tone: tones) {
+            sample += std::sin(2.0f * std::numbers::pi_v<f32> * tone * static_cast<f32>(i) / SAMPLE_RATE);
+        }
+        pcm[i] = static_cast<s16>(sample * 5000.0f);
+    }
+    return pcm;
+}
+
+/**
+ * Simulates another encoding of the audio, which starts a bit later, is quieter and carries noise
+ * @param pcm The samples
+ * @return The samples of the other encoding
+ */
+std::vector<s16> reencode(std::vector<s16> const &pcm) {
+    std::mt19937 random{ 9 };
+    std::normal_distribution<f32> noise{ 0.0f, 300.0f };
+
+    std::vector<s16> result(pcm.begin() + 1000, pcm.end());
+    for (auto &sample: result) {
+        sample = static_cast<s16>(std::clamp(static_cast<f32>(sample) * 0.6f + noise(random), -32768.0f, 32767.0f));
+    }
+    return result;
+}
+
+/**
+ * Fingerprints audio in windows that do not line up with the frames of the fingerprint
+ * @param pcm The samples
+ * @return The fingerprint
+ */
+Fingerprint fingerprint(std::span<s16 const> const pcm) {
+    Fingerprinter fingerprinter;
+    for (usize offset = 0; offset < pcm.size(); offset += 7777) {
+        fingerprinter.feed(pcm.subspan(offset, std::min<usize>(7777, pcm.size() - offset)));
+    }
+    return fingerprinter.finish();
+}
+
+/**
+ * The index of the tests, it holds a few unrelated transcripts and the transcript of a three minute melody
+ */
+class FingerprintIndexTest : public testing::Test {
+protected:
+    FingerprintIndexTest()
+        : m_index{ 100, 0.3 },
+          m_pcm{ melody(1, 180) } {
+        for (u32 seed = 100; seed < 105; ++seed) {
+            m_index.insert(fingerprint(melody(seed, 60)), USER, SETTINGS, { "other" });
+        }
+        m_index.insert(fingerprint(m_pcm), USER, SETTINGS, { "melody" });
+    }
+
+    FingerprintIndex m_index;
+    std::vector<s16> m_pcm;
+};
+
+}// anonymous namespace
+
+TEST(FingerprinterTest, EmitsTheAnnouncedAmountOfFrames) {
+    auto const pcm = melody(1, 8);
+    for (usize const samples: { 0, 1000, 4096, 16000, 16000 * 7 + 123 }) {
+        EXPECT_EQ(fingerprint(std::span{ pcm }.first(samples)).size(), Fingerprinter::frames(samples))
+                << samples << " samples";
+    }
+}
+
+TEST(FingerprinterTest, StartsOverAfterFinish) {
+    auto const pcm = melody(1, 10);
+    Fingerprinter fingerprinter;
+    fingerprinter.feed(melody(2, 10));
+    static_cast<void>(fingerprinter.finish());
+
+    fingerprinter.feed(pcm);
+    EXPECT_EQ(fingerprinter.finish(), fingerprint(pcm));
+}
+
+TEST_F(FingerprintIndexTest, FindsAnotherEncoding) {
+    auto const other = reencode(m_pcm);
+    EXPECT_TRUE(m_index.has_candidate(fingerprint(std::span{ other }.first(SAMPLE_RATE * 60)), USER, SETTINGS));
+
+    auto const match = m_index.find(fingerprint(other), USER, SETTINGS);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->segments, std::vector<std::string>{ "melody" });
+    EXPECT_LT(match->bit_error_rate, 0.3);
+}
+
+TEST_F(FingerprintIndexTest, FindsShortAudio) {
+    auto const match = m_index.find(fingerprint(melody(103, 60)), USER, SETTINGS);
+    ASSERT_TRUE(match);
+    EXPECT_EQ(match->segments, std::vector<std::string>{ "other" });
+}
+
+TEST_F(FingerprintIndexTest, IgnoresOtherUsers) {
+    auto const other = reencode(m_pcm);
+    EXPECT_FALSE(m_index.has_candidate(fingerprint(std::span{ other }.first(SAMPLE_RATE * 60)), "bob", SETTINGS));
+    EXPECT_FALSE(m_index.find(fingerprint(other), "bob", SETTINGS));
+}
+
+TEST_F(FingerprintIndexTest, IgnoresOtherSettings) {
+    EXPECT_FALSE(m_index.find(fingerprint(reencode(m_pcm)), USER, "other-model"));
+}
+
+TEST_F(FingerprintIndexTest, IgnoresAudioOfAnotherLength) {
+    auto const other = reencode(m_pcm);
+
+    // The transcript of the whole melody does not fit the first half of it, or a clip of its start
+    EXPECT_FALSE(m_index.find(fingerprint(std::span{ other }.first(other.size() / 2)), USER, SETTINGS));
+    EXPECT_FALSE(m_index.find(fingerprint(std::span{ other }.first(SAMPLE_RATE * 60)), USER, SETTINGS));
+}
+
+TEST_F(FingerprintIndexTest, IgnoresAudioThatSharesItsStart) {
+    // Audio of the same length with the same intro, like another episode of a series
+    auto pcm = melody(7, 180);
+    std::ranges::copy(std::span{ m_pcm }.first(SAMPLE_RATE * 120), pcm.begin());
+    auto const other = reencode(pcm);
+
+    EXPECT_TRUE(m_index.has_candidate(fingerprint(std::span{ other }.first(SAMPLE_RATE * 60)), USER, SETTINGS));
+    EXPECT_FALSE(m_index.find(fingerprint(other), USER, SETTINGS));
+}
+
+TEST_F(FingerprintIndexTest, IgnoresAudioThatDiffersInOnePart) {
+    // The differing 20 seconds would vanish in the bit error rate of the whole three minutes
+    auto pcm = m_pcm;
+    auto const part = melody(7, 20);
+    std::ranges::copy(part, pcm.begin() + SAMPLE_RATE * 140);
+    EXPECT_FALSE(m_index.find(fingerprint(reencode(pcm)), USER, SETTINGS));
+}
+
+TEST_F(FingerprintIndexTest, IgnoresOtherAudio) {
+    auto const pcm = melody(5, 180);
+    EXPECT_FALSE(m_index.has_candidate(fingerprint(std::span{ pcm }.first(SAMPLE_RATE * 60)), USER, SETTINGS));
+    EXPECT_FALSE(m_index.find(fingerprint(pcm), USER, SETTINGS));
+}
+
+TEST(FingerprintIndexCapacityTest, DropsTheOldestTranscripts) {
+    FingerprintIndex index{ 2, 0.3 };
+    std::vector<Fingerprint> fingerprints;
+    for (u32 seed = 1; seed <= 3; ++seed) {
+        fingerprints.push_back(fingerprint(melody(seed, 20)));
+        index.insert(fingerprints.back(), USER, SETTINGS, { std::to_string(seed) });
+    }
+    EXPECT_EQ(index.size(), 2);
+
+    EXPECT_FALSE(index.find(fingerprints[0], USER, SETTINGS));
+    EXPECT_TRUE(index.find(fingerprints[1], USER, SETTINGS));
+    EXPECT_TRUE(index.find(fingerprints[2], USER, SETTINGS));
+}
+
+TEST(FingerprintIndexCapacityTest, IgnoresShortFingerprints) {
+    FingerprintIndex index{ 2, 0.3 };
+    auto const pcm = melody(1, 20);
+    index.insert(fingerprint(std::span{ pcm }.first(SAMPLE_RATE)), USER, SETTINGS, { "short" });
+    EXPECT_EQ(index.size(), 0);
+}
@@ -0,0 +1,138 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "utils/hash.h"
+
+namespace {
+
+// The primes that generate the sanity buffer of the reference implementation
+constexpr std::uint64_t PRIME32 = 2654435761ULL;
+constexpr std::uint64_t PRIME64 = 11400714785074694797ULL;
+
+/**
+ * Generates the sanity buffer the reference implementation verifies its hashes with
+ * @param size The size of the buffer
+ * @return The buffer
+ */
+std::vector<std::uint8_t> sanity_buffer(std::size_t const size) {
+    std::vector<std::uint8_t> buffer(size);
+    auto generator = PRIME32;
+    for (auto &byte: buffer) {
+        byte = static_cast<std::uint8_t>(generator >> 56);
+        generator *= PRIME64;
+    }
+    return buffer;
+}
+
+/**
+ * Hashes data at once
+ * @param data The data
+ * @param size The size of the data in bytes
+ * @param seed The seed of the hash
+ * @return The hash
+ */
+std::uint64_t hash(void const *data, std::size_t const size, std::uint64_t const seed = 0) {
+    utils::XXHash64 hasher{ seed };
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+/**
+ * Hashes a text at once with the seed 0
+ * @param text The text
+ * @return The hash
+ */
+std::uint64_t hash(std::string_view const text) {
+    return hash(text.data(), text.size());
+}
+
+}// anonymous namespace
+
+TEST(XXHash64Test, MatchesReferenceStrings) {
+    EXPECT_EQ(hash(""), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(hash("a"), 0xD24EC4F1A98C6E5BULL);
+    EXPECT_EQ(hash("abc"), 0x44BC2CF5AD770999ULL);
+    EXPECT_EQ(hash("Nobody inspects the spammish repetition"), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(XXHash64Test, MatchesReferenceSanityVectors) {
+    struct Vector {
+        std::size_t size;
+        std::uint64_t seed;
+        std::uint64_t expected;
+    };
+
+    // The sizes cover the tails of single bytes, words and lanes as well as whole stripes
+    constexpr Vector VECTORS[] = {
+        { 0, 0, 0xEF46DB3751D8E999ULL },
+        { 1, 0, 0xE934A84ADB052768ULL },
+        { 1, PRIME32, 0x5014607643A9B4C3ULL },
+        { 4, 0, 0x9136A0DCA57457EEULL },
+        { 8, 0, 0xCDBCF538E71D1348ULL },
+        { 14, 0, 0x8282DCC4994E35C8ULL },
+        { 14, PRIME32, 0xC3BD6BF63DEB6DF0ULL },
+        { 32, 0, 0x18B216492BB44B70ULL },
+        { 222, 0, 0xB641AE8CB691C174ULL },
+        { 222, PRIME32, 0x20CB8AB7AE10C14AULL },
+        { 2367, 0, 0xA82418DDEC0EA581ULL },
+        { 2367, PRIME32, 0xA36A93C18052673AULL },
+    };
+
+    auto const buffer = sanity_buffer(2367);
+    for (auto const &vector: VECTORS) {
+        EXPECT_EQ(hash(buffer.data(), vector.size, vector.seed), vector.expected)
+                << "size " << vector.size << ", seed " << vector.seed;
+    }
+}
+
+TEST(XXHash64Test, HashesPiecesLikeTheirConcatenation) {
+    auto const buffer = sanity_buffer(1000);
+    for (std::size_t piece: { 1, 3, 7, 31, 32, 33, 100 }) {
+        utils::XXHash64 hasher{ PRIME32 };
+        for (std::size_t offset = 0; offset < buffer.size(); offset += piece) {
+            hasher.update(buffer.data() + offset, std::min(piece, buffer.size() - offset));
+        }
+        EXPECT_EQ(hasher.digest(), hash(buffer.data(), buffer.size(), PRIME32)) << "pieces of " << piece;
+    }
+}
+
+TEST(XXHash64Test, ContinuesAfterDigest) {
+    auto const buffer = sanity_buffer(100);
+    utils::XXHash64 hasher;
+    hasher.update(buffer.data(), 40);
+    EXPECT_EQ(hasher.digest(), hash(buffer.data(), 40));
+
+    hasher.update(buffer.data() + 40, 60);
+    EXPECT_EQ(hasher.digest(), hash(buffer.data(), 100));
+}
+
+TEST(XXHash64Test, DependsOnTheSeed) {
+    auto const buffer = sanity_buffer(64);
+    EXPECT_NE(hash(buffer.data(), buffer.size(), 0), hash(buffer.data(), buffer.size(), 1));
+}
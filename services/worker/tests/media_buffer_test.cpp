@@ -0,0 +1,152 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "media_buffer.h"
+
+namespace {
+
+/**
+ * Fills a buffer with chunks of the given sizes, the bytes count up from 0
+ * @param sizes The sizes of the chunks
+ * @return The buffer and the concatenation of its chunks
+ */
+std::pair<MediaBuffer, std::string> make_buffer(std::initializer_list<usize> sizes) {
+    MediaBuffer buffer;
+    std::string contents;
+    for (auto const size: sizes) {
+        std::string chunk;
+        for (usize i = 0; i < size; ++i) {
+            chunk.push_back(static_cast<char>(contents.size() + i));
+        }
+        contents += chunk;
+        buffer.append(std::move(chunk));
+    }
+    return { std::move(buffer), std::move(contents) };
+}
+
+/**
+ * Reads the rest of the buffer in pieces of the given size
+ * @param reader The reader
+ * @param piece The size of the pieces
+ * @return The bytes that were read
+ */
+std::string read_rest(MediaBuffer::Reader &reader, usize const piece) {
+    std::string result;
+    std::string buffer(piece, '\0');
+    while (auto const read = reader.read(reinterpret_cast<u8 *>(buffer.data()), piece)) {
+        result.append(buffer.data(), read);
+    }
+    return result;
+}
+
+}// anonymous namespace
+
+TEST(MediaBufferTest, ReadsAcrossChunks) {
+    auto const [buffer, contents] = make_buffer({ 3, 0, 5, 1, 7 });
+    EXPECT_EQ(buffer.size(), contents.size());
+
+    for (usize piece = 1; piece <= contents.size() + 1; ++piece) {
+        MediaBuffer::Reader reader{ buffer };
+        EXPECT_EQ(read_rest(reader, piece), contents) << "piece size " << piece;
+    }
+}
+
+TEST(MediaBufferTest, SeeksToEveryPosition) {
+    auto const [buffer, contents] = make_buffer({ 4, 1, 6, 3 });
+    MediaBuffer::Reader reader{ buffer };
+
+    // Every position is reached from the front and from behind, i.e. both ways across chunk boundaries
+    for (usize position = 0; position <= contents.size(); ++position) {
+        ASSERT_EQ(reader.seek(static_cast<ssize>(position), SEEK_SET), static_cast<ssize>(position));
+        EXPECT_EQ(read_rest(reader, 2), contents.substr(position));
+    }
+    for (usize position = contents.size() + 1; position-- > 0;) {
+        ASSERT_EQ(reader.seek(static_cast<ssize>(position), SEEK_SET), static_cast<ssize>(position));
+        EXPECT_EQ(read_rest(reader, 3), contents.substr(position));
+    }
+}
+
+TEST(MediaBufferTest, SeeksRelativeToCurrentAndEnd) {
+    auto const [buffer, contents] = make_buffer({ 5, 5, 5 });
+    MediaBuffer::Reader reader{ buffer };
+
+    u8 byte = 0;
+    ASSERT_EQ(reader.seek(7, SEEK_SET), 7);
+    ASSERT_EQ(reader.read(&byte, 1), 1u);
+    EXPECT_EQ(byte, 7);
+
+    EXPECT_EQ(reader.seek(-6, SEEK_CUR), 2);
+    ASSERT_EQ(reader.read(&byte, 1), 1u);
+    EXPECT_EQ(byte, 2);
+
+    EXPECT_EQ(reader.seek(-1, SEEK_END), 14);
+    ASSERT_EQ(reader.read(&byte, 1), 1u);
+    EXPECT_EQ(byte, 14);
+
+    EXPECT_EQ(reader.seek(0, SEEK_END), 15);
+    EXPECT_EQ(reader.read(&byte, 1), 0u);
+}
+
+TEST(MediaBufferTest, RejectsPositionsOutsideTheBuffer) {
+    auto const [buffer, contents] = make_buffer({ 4, 4 });
+    MediaBuffer::Reader reader{ buffer };
+    ASSERT_EQ(reader.seek(3, SEEK_SET), 3);
+
+    EXPECT_EQ(reader.seek(-1, SEEK_SET), -1);
+    EXPECT_EQ(reader.seek(9, SEEK_SET), -1);
+    EXPECT_EQ(reader.seek(-4, SEEK_CUR), -1);
+    EXPECT_EQ(reader.seek(1, SEEK_END), -1);
+    EXPECT_EQ(reader.seek(0, 42), -1);
+
+    // A rejected seek keeps the position
+    EXPECT_EQ(read_rest(reader, 4), contents.substr(3));
+}
+
+TEST(MediaBufferTest, ReadersAreIndependent) {
+    auto const [buffer, contents] = make_buffer({ 2, 3, 4 });
+    MediaBuffer::Reader first{ buffer };
+    MediaBuffer::Reader second{ buffer };
+
+    ASSERT_EQ(first.seek(6, SEEK_SET), 6);
+    EXPECT_EQ(read_rest(second, 4), contents);
+    EXPECT_EQ(read_rest(first, 4), contents.substr(6));
+    EXPECT_EQ(first.size(), static_cast<ssize>(contents.size()));
+    EXPECT_TRUE(first.seekable());
+}
+
+TEST(MediaBufferTest, EmptyBuffer) {
+    MediaBuffer buffer;
+    buffer.append({});
+    EXPECT_TRUE(buffer.empty());
+
+    MediaBuffer::Reader reader{ buffer };
+    u8 byte = 0;
+    EXPECT_EQ(reader.read(&byte, 1), 0u);
+    EXPECT_EQ(reader.seek(0, SEEK_END), 0);
+    EXPECT_EQ(reader.seek(1, SEEK_SET), -1);
+}
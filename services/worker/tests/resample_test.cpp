@@ -0,0 +1,219 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "resample.h"
+
+namespace {
+
+/**
+ * Resamples generated input in pieces of varying size
+ * @param layout The sample layout of the input
+ * @param rate The sample rate of the input
+ * @param channels The amount of channels of the input
+ * @param frames The amount of samples per channel
+ * @param vectorized Whether the vectorized kernels are used
+ * @return The output at 16 kHz mono, including the flushed samples
+ */
+std::vector<f32> resample(SampleLayout const layout,
+                          int const rate,
+                          int const channels,
+                          usize const frames,
+                          bool const vectorized) {
+    std::mt19937 random{ 7 };
+    std::uniform_real_distribution<f32> amplitude{ -0.9f, 0.9f };
+
+    // Planar layouts have a plane per channel, interleaved layouts one plane with all channels
+    auto const planar = layout == SampleLayout::S16P or layout == SampleLayout::F32P;
+    auto const planes = planar ? channels : 1;
+    auto const per_plane = planar ? frames : frames * static_cast<usize>(channels);
+    std::vector<std::vector<f32>> f32_planes(static_cast<usize>(planes), std::vector<f32>(per_plane));
+    std::vector<std::vector<s16>> s16_planes(static_cast<usize>(planes), std::vector<s16>(per_plane));
+    for (usize plane = 0; plane < f32_planes.size(); ++plane) {
+        for (usize i = 0; i < per_plane; ++i) {
+            f32_planes[plane][i] = amplitude(random);
+            s16_planes[plane][i] = static_cast<s16>(f32_planes[plane][i] * 32767.0f);
+        }
+    }
+
+    auto resampler = FastResampler::create(layout, rate, channels, vectorized);
+    std::vector<f32> out;
+    usize offset = 0;
+    for (usize piece = 1; offset < frames; piece = piece * 3 + 1) {
+        auto const count = std::min(piece, frames - offset);
+        auto const element = planar ? offset : offset * static_cast<usize>(channels);
+        std::vector<u8 const *> data;
+        for (usize plane = 0; plane < f32_planes.size(); ++plane) {
+            auto const is_s16 = layout == SampleLayout::S16 or layout == SampleLayout::S16P;
+            data.push_back(is_s16 ? reinterpret_cast<u8 const *>(s16_planes[plane].data() + element)
+                                  : reinterpret_cast<u8 const *>(f32_planes[plane].data() + element));
+        }
+        resampler->process(data.data(), count, out);
+        offset += count;
+    }
+    resampler->flush(out);
+    return out;
+}
+
+}// anonymous namespace
+
+TEST(ResampleTest, VectorizedMatchesScalar) {
+    for (auto const layout: { SampleLayout::S16, SampleLayout::S16P, SampleLayout::F32, SampleLayout::F32P }) {
+        for (auto const rate: { 48000, 44100, 16000 }) {
+            for (auto const channels: { 1, 2 }) {
+                auto const vectorized = resample(layout, rate, channels, 10007, true);
+                auto const scalar = resample(layout, rate, channels, 10007, false);
+                ASSERT_EQ(vectorized.size(), scalar.size());
+
+                // The vectorized dot product sums in another order, which only differs by rounding
+                for (usize i = 0; i < scalar.size(); ++i) {
+                    ASSERT_NEAR(vectorized[i], scalar[i], 1e-5f)
+                            << "layout " << static_cast<int>(layout) << ", rate " << rate << ", channels " << channels
+                            << ", sample " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(ResampleTest, EmitsTheExactAmountOfSamples) {
+    for (auto const rate: { 48000, 44100, 16000 }) {
+        for (auto const frames: { 1ul, 440ul, 44101ul, 96000ul }) {
+            auto const out = resample(SampleLayout::F32, rate, 1, frames, true);
+            EXPECT_EQ(out.size(), (frames * 16000 + static_cast<usize>(rate) - 1) / static_cast<usize>(rate))
+                    << "rate " << rate << ", frames " << frames;
+        }
+    }
+}
+
+TEST(ResampleTest, PreservesTonesBelowTheCutoff) {
+    for (auto const rate: { 48000, 44100 }) {
+        for (auto const frequency: { 440.0, 3000.0, 5000.0 }) {
+            auto const frames = static_cast<usize>(rate);
+            std::vector<f32> input(frames);
+            for (usize i = 0; i < frames; ++i) {
+                auto const phase = 2.0 * std::numbers::pi * frequency * static_cast<f64>(i) / rate;
+                input[i] = 0.5f * static_cast<f32>(std::sin(phase));
+            }
+
+            auto resampler = FastResampler::create(SampleLayout::F32, rate, 1);
+            std::vector<f32> out;
+            u8 const *data[] = { reinterpret_cast<u8 const *>(input.data()) };
+            resampler->process(data, frames, out);
+            resampler->flush(out);
+
+            // The edges are skipped, the filter starts and ends on zeros there. The tones lie in the passband,
+            // the transition band towards the cutoff at 7.2 kHz attenuates more.
+            f64 error = 0.0;
+            for (usize i = 200; i + 200 < out.size(); ++i) {
+                auto const phase = 2.0 * std::numbers::pi * frequency * static_cast<f64>(i) / 16000.0;
+                error = std::max(error, std::abs(out[i] - 0.5 * std::sin(phase)));
+            }
+            EXPECT_LT(error, 2e-3) << "rate " << rate << ", frequency " << frequency;
+        }
+    }
+}
+
+TEST(ResampleTest, LayoutsAgree) {
+    // The same stereo signal in every layout, the s16 samples are exact in float
+    constexpr usize frames = 4801;
+    std::vector<s16> interleaved(2 * frames);
+    for (usize i = 0; i < interleaved.size(); ++i) {
+        interleaved[i] = static_cast<s16>((i * 7919) % 65536 - 32768);
+    }
+    std::vector<s16> left(frames);
+    std::vector<s16> right(frames);
+    std::vector<f32> interleaved_f32(2 * frames);
+    for (usize i = 0; i < frames; ++i) {
+        left[i] = interleaved[2 * i];
+        right[i] = interleaved[2 * i + 1];
+    }
+    for (usize i = 0; i < interleaved.size(); ++i) {
+        interleaved_f32[i] = static_cast<f32>(interleaved[i]) / 32768.0f;
+    }
+
+    auto const run = [](SampleLayout const layout, std::vector<u8 const *> const &data) {
+        auto resampler = FastResampler::create(layout, 48000, 2);
+        std::vector<f32> out;
+        resampler->process(data.data(), frames, out);
+        resampler->flush(out);
+        return out;
+    };
+    auto const s16 = run(SampleLayout::S16, { reinterpret_cast<u8 const *>(interleaved.data()) });
+    auto const s16p = run(SampleLayout::S16P,
+                          { reinterpret_cast<u8 const *>(left.data()), reinterpret_cast<u8 const *>(right.data()) });
+    auto const f32 = run(SampleLayout::F32, { reinterpret_cast<u8 const *>(interleaved_f32.data()) });
+
+    ASSERT_EQ(s16.size(), s16p.size());
+    ASSERT_EQ(s16.size(), f32.size());
+    for (usize i = 0; i < s16.size(); ++i) {
+        EXPECT_NEAR(s16[i], s16p[i], 1e-6f);
+        EXPECT_NEAR(s16[i], f32[i], 1e-6f);
+    }
+}
+
+TEST(ResampleTest, RejectsUnsupportedFormats) {
+    EXPECT_EQ(FastResampler::create(SampleLayout::S16, 22050, 2), nullptr);
+    EXPECT_EQ(FastResampler::create(SampleLayout::F32, 48000, 6), nullptr);
+    EXPECT_EQ(FastResampler::create(SampleLayout::F32, 48000, 0), nullptr);
+    EXPECT_NE(FastResampler::create(SampleLayout::F32P, 44100, 1), nullptr);
+}
+
+TEST(ResampleTest, ConvertsS16ToF32) {
+    std::vector<s16> samples(65536);
+    for (usize i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<s16>(static_cast<s32>(i) - 32768);
+    }
+
+    std::vector<f32> converted(samples.size());
+    convert_s16_to_f32(samples.data(), samples.size(), converted.data());
+    for (usize i = 0; i < samples.size(); ++i) {
+        ASSERT_EQ(converted[i], static_cast<f32>(samples[i]) / 32768.0f);
+    }
+}
+
+TEST(ResampleTest, ConvertsF32ToS16) {
+    // Full scale, beyond full scale and halfway between two steps, where the rounding matters. The odd count
+    // exercises the tail of the vectorized kernel.
+    std::vector<f32> samples{ 0.0f,  1.0f,   -1.0f, 1.5f, -1.5f, 0.5f / 32768.0f, 1.5f / 32768.0f, -2.5f / 32768.0f,
+                              0.25f, 0.999f, 1e-9f, 0.3f, -0.7f };
+    std::mt19937 random{ 3 };
+    std::uniform_real_distribution<f32> amplitude{ -1.2f, 1.2f };
+    for (usize i = 0; i < 1000; ++i) {
+        samples.push_back(amplitude(random));
+    }
+
+    std::vector<s16> converted(samples.size());
+    convert_f32_to_s16(samples.data(), samples.size(), converted.data());
+    for (usize i = 0; i < samples.size(); ++i) {
+        auto const expected = std::clamp(std::nearbyint(samples[i] * 32768.0f), -32768.0f, 32767.0f);
+        ASSERT_EQ(converted[i], static_cast<s16>(expected)) << "sample " << samples[i];
+    }
+}
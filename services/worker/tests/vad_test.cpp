@@ -0,0 +1,262 @@
+//
+//  MIT License
+//
+//  Copyright (c) 2025 multimedia-workforce
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "vad.h"
+
+namespace {
+
+constexpr usize SAMPLE_RATE = 16000;
+
+/**
+ * Decoded samples that are held in memory
+ */
+class MemorySource final : public PcmSource {
+public:
+    explicit MemorySource(std::vector<s16> samples) : m_samples{ std::move(samples) } { }
+
+    [[nodiscard]] std::span<s16 const> samples() const override {
+        return m_samples;
+    }
+
+private:
+    std::vector<s16> m_samples;
+};
+
+/**
+ * Generates audio from spans of quiet noise and loud modulated tones, which the energy detector tells apart
+ */
+class Signal {
+public:
+    /**
+     * Appends quiet noise
+     * @param seconds The duration
+     */
+    void noise(f64 const seconds) {
+        append(seconds, false);
+    }
+
+    /**
+     * Appends a loud tone over the noise, with the amplitude modulated like syllables
+     * @param seconds The duration
+     */
+    void tone(f64 const seconds) {
+        append(seconds, true);
+    }
+
+    /**
+     * Opens a PCM stream on the generated audio
+     * @return The stream
+     */
+    [[nodiscard]] PcmStream open() const {
+        return PcmStream::open_decoded(std::make_unique<MemorySource>(m_samples));
+    }
+
+    [[nodiscard]] std::vector<s16> const &samples() const {
+        return m_samples;
+    }
+
+private:
+    void append(f64 const seconds, bool const tone) {
+        auto const count = static_cast<usize>(seconds * SAMPLE_RATE);
+        for (usize i = 0; i < count; ++i) {
+            auto const t = static_cast<f64>(m_samples.size()) / SAMPLE_RATE;
+            auto sample = static_cast<f64>(m_noise(m_random));
+            if (tone) {
+                sample += 8000.0 * std::sin(2.0 * std::numbers::pi * 220.0 * t) *
+                          (1.0 + 0.5 * std::sin(2.0 * std::numbers::pi * 3.0 * t));
+            }
+            m_samples.push_back(static_cast<s16>(sample));
+        }
+    }
+
+    std::mt19937 m_random{ 1 };
+    std::normal_distribution<f32> m_noise{ 0.0f, 30.0f };
+    std::vector<s16> m_samples;
+};
+
+/**
+ * Reads all windows of a speech stream
+ * @param stream The speech stream
+ * @param size The maximum size of the windows
+ * @return The windows
+ */
+std::vector<std::vector<s16>> read_windows(SpeechStream &stream, usize const size) {
+    std::vector<std::vector<s16>> windows;
+    for (auto window = stream.next_window(size); not window.empty(); window = stream.next_window(size)) {
+        windows.emplace_back(window.begin(), window.end());
+    }
+    return windows;
+}
+
+}// anonymous namespace
+
+TEST(EnergyDetectorTest, TellsToneFromSilence) {
+    EnergyDetector detector;
+    std::vector<s16> frame(VoiceDetector::FRAME_SIZE);
+
+    // The noise floor adapts to the quiet frames first
+    std::mt19937 random{ 5 };
+    std::normal_distribution<f32> noise{ 0.0f, 30.0f };
+    for (usize i = 0; i < 20; ++i) {
+        std::ranges::generate(frame, [&] { return static_cast<s16>(noise(random)); });
+        EXPECT_FALSE(detector.is_speech(frame));
+    }
+
+    for (usize i = 0; i < frame.size(); ++i) {
+        auto const phase = 2.0 * std::numbers::pi * 220.0 * static_cast<f64>(i) / SAMPLE_RATE;
+        frame[i] = static_cast<s16>(8000.0 * std::sin(phase));
+    }
+    EXPECT_TRUE(detector.is_speech(frame));
+}
+
+TEST(EnergyDetectorTest, IgnoresLoudBroadbandNoise) {
+    EnergyDetector detector;
+    std::vector<s16> frame(VoiceDetector::FRAME_SIZE, 0);
+    (void) detector.is_speech(frame);
+
+    std::mt19937 random{ 2 };
+    std::normal_distribution<f32> noise{ 0.0f, 3000.0f };
+    usize speech = 0;
+    for (usize i = 0; i < 20; ++i) {
+        std::ranges::generate(frame, [&] { return static_cast<s16>(noise(random)); });
+        speech += detector.is_speech(frame) ? 1 : 0;
+    }
+    EXPECT_EQ(speech, 0u);
+}
+
+TEST(SpeechStreamTest, KeepsEverythingWithoutDetector) {
+    Signal signal;
+    signal.noise(2.0);
+    signal.tone(1.5);
+    auto pcm_stream = signal.open();
+    SpeechStream stream{ pcm_stream, nullptr };
+
+    std::vector<s16> kept;
+    for (auto const &window: read_windows(stream, SAMPLE_RATE)) {
+        kept.insert(kept.end(), window.begin(), window.end());
+    }
+    EXPECT_EQ(kept, signal.samples());
+    EXPECT_EQ(stream.speech_samples(), stream.total_samples());
+    EXPECT_EQ(stream.source_position(12345), 12345u);
+}
+
+TEST(SpeechStreamTest, DropsSilenceAndMapsPositionsBack) {
+    Signal signal;
+    signal.noise(10.0);
+    signal.tone(3.0);
+    signal.noise(10.0);
+    signal.tone(2.0);
+    signal.noise(0.4);
+    auto pcm_stream = signal.open();
+    SpeechStream stream{ pcm_stream, std::make_unique<EnergyDetector>() };
+
+    std::vector<s16> kept;
+    for (auto const &window: read_windows(stream, 30 * SAMPLE_RATE)) {
+        kept.insert(kept.end(), window.begin(), window.end());
+    }
+    EXPECT_EQ(stream.total_samples(), signal.samples().size());
+    EXPECT_EQ(stream.speech_samples(), kept.size());
+
+    // The five seconds of tones are kept with some padding, the twenty seconds of noise are not
+    EXPECT_GE(kept.size(), 5 * SAMPLE_RATE);
+    EXPECT_LE(kept.size(), 7 * SAMPLE_RATE);
+
+    // Every kept sample maps back to the sample it came from, the first tone starts after ten seconds
+    for (usize position = 0; position < kept.size(); ++position) {
+        ASSERT_EQ(kept[position], signal.samples()[stream.source_position(position)]) << "position " << position;
+    }
+    EXPECT_GE(stream.source_position(0), 9 * SAMPLE_RATE);
+    EXPECT_LT(stream.source_position(0), 10 * SAMPLE_RATE);
+    EXPECT_GE(stream.source_position(kept.size() - 1), 23 * SAMPLE_RATE);
+}
+
+TEST(SpeechStreamTest, EndsWindowsInPauses) {
+    // Loud speech with two short pauses, each within the tolerance before the end of a 30 second window
+    Signal signal;
+    signal.tone(28.7);
+    signal.noise(0.05);
+    signal.tone(28.25);
+    signal.noise(0.05);
+    signal.tone(13.0);
+    auto pcm_stream = signal.open();
+    SpeechStream stream{ pcm_stream, nullptr, 2 * SAMPLE_RATE };
+
+    auto const windows = read_windows(stream, 30 * SAMPLE_RATE);
+    ASSERT_EQ(windows.size(), 3u);
+
+    // The windows end within the pauses instead of at their maximum size
+    auto const first_end = windows[0].size();
+    auto const second_end = first_end + windows[1].size();
+    EXPECT_GE(first_end, static_cast<usize>(28.7 * SAMPLE_RATE));
+    EXPECT_LE(first_end, static_cast<usize>(28.75 * SAMPLE_RATE));
+    EXPECT_GE(second_end, static_cast<usize>(57.0 * SAMPLE_RATE));
+    EXPECT_LE(second_end, static_cast<usize>(57.05 * SAMPLE_RATE));
+
+    // No sample is lost or repeated at the boundaries
+    std::vector<s16> kept;
+    for (auto const &window: windows) {
+        kept.insert(kept.end(), window.begin(), window.end());
+    }
+    EXPECT_EQ(kept, signal.samples());
+}
+
+TEST(SpeechStreamTest, CutsWindowsAtTheirSizeWithoutTolerance) {
+    Signal signal;
+    signal.tone(28.7);
+    signal.noise(0.05);
+    signal.tone(40.0);
+
+    // Tolerances below one block of the boundary search cut at the maximum size as well
+    for (auto const tolerance: { usize{ 0 }, usize{ 100 } }) {
+        auto pcm_stream = signal.open();
+        SpeechStream stream{ pcm_stream, nullptr, tolerance };
+
+        auto const windows = read_windows(stream, 30 * SAMPLE_RATE);
+        ASSERT_EQ(windows.size(), 3u);
+        EXPECT_EQ(windows[0].size(), 30 * SAMPLE_RATE);
+        EXPECT_EQ(windows[1].size(), 30 * SAMPLE_RATE);
+        EXPECT_EQ(windows[2].size(), signal.samples().size() - 60 * SAMPLE_RATE);
+    }
+}
+
+TEST(SpeechStreamTest, KeepsTheLastWindowWhole) {
+    // The stream ends within the window, so there is no boundary to search even though the tail is quiet
+    Signal signal;
+    signal.tone(20.0);
+    signal.noise(1.0);
+    signal.tone(8.5);
+    auto pcm_stream = signal.open();
+    SpeechStream stream{ pcm_stream, nullptr, 10 * SAMPLE_RATE };
+
+    auto const windows = read_windows(stream, 30 * SAMPLE_RATE);
+    ASSERT_EQ(windows.size(), 1u);
+    EXPECT_EQ(windows[0], signal.samples());
+}